@@ -1,42 +1,282 @@
 #include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
 #include <cstdint>
 #include <limits>
+#include <tuple>
+#include <stdexcept>
 #include <iostream>
 #include <iterator>
+#include <string>
+#include <thread>
 #include <vector>
 #include <sstream>
 
-namespace common {
-    template <typename T>
-    concept ReservableEmplacableContainer = requires (T c) {
-        typename T::value_type;
-        c.reserve(size_t{0});
-        c.emplace_back();
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+#include "common/input.h"
+#include "common/output.h"
+
+namespace solution {
+    // Решение, которое привело нас в точку (day, tickets) из предыдущего дня. Для восстановления
+    // истории использования купонов нам достаточно знать только его, так что вместо копирования
+    // всей истории в каждую точку карты храним по 2 бита на точку.
+    //
+    // Биты выставляются независимо: младший если вариант с получением купона оказался выгоднее
+    // варианта без купона, старший если вариант с тратой купона оказался выгоднее лучшего из
+    // предыдущих. Так их удобно получать прямо из масок сравнения векторных инструкций, а при
+    // восстановлении старший бит просто имеет приоритет.
+    enum Decision : std::uint8_t {
+        kTicketUnused = 0b00,
+        kTicketGained = 0b01,
+        kTicketUsed = 0b10,
     };
 
-    template <typename Value>
-    auto getFromStdin() -> Value {
-        Value var;
-        std::cin >> var;
-        if (!std::cin.good()) {
-            throw std::runtime_error("Failed to read value from stdin");
+    // Упакованная таблица решений. Строки разной ширины: в каждый день хранятся решения только
+    // для того количества купонов, которое к этому дню вообще можно было получить.
+    class DecisionsTable {
+    public:
+        constexpr static size_t kBitsPerCell = 2;
+        constexpr static size_t kCellsPerByte = 8 / kBitsPerCell;
+
+        constexpr static auto bytesForCells(const size_t cells) -> size_t {
+            return (cells + kCellsPerByte - 1) / kCellsPerByte;
         }
-        return var;
-    }
 
-    template <ReservableEmplacableContainer Collection, typename ... Args>
-    auto getFromStdin(const size_t n, Args ... ns) -> Collection {
-        Collection collection;
-        collection.reserve(n);
-        for (size_t i = 0; i < n; ++i) {
-            collection.emplace_back(
-                getFromStdin<typename Collection::value_type>(ns...));
+        auto clear() -> void {
+            __days_offsets.clear();
+            __data.clear();
         }
-        return collection;
-    }
-}  // namespace common
 
-namespace solution {
+        // Добавляет обнуленную строку для следующего дня. Указатель действителен до следующего вызова.
+        auto addDay(const size_t cells) -> std::uint8_t* {
+            const size_t offset = __data.size();
+            __days_offsets.emplace_back(offset);
+            __data.resize(offset + bytesForCells(cells), 0);
+            return __data.data() + offset;
+        }
+
+        auto get(const size_t day, const size_t tickets_count) const -> Decision {
+            return decode(__data.data() + __days_offsets[day], tickets_count);
+        }
+
+        static auto decode(const std::uint8_t* day_decisions, const size_t tickets_count) -> Decision {
+            const auto cell = day_decisions[tickets_count / kCellsPerByte]
+                >> (tickets_count % kCellsPerByte * kBitsPerCell);
+            if (cell & kTicketUsed) {
+                return kTicketUsed;
+            }
+            return static_cast<Decision>(cell & kTicketGained);
+        }
+
+    private:
+        std::vector<size_t> __days_offsets;
+        std::vector<std::uint8_t> __data;
+    };
+
+    // Ядра, которые по строке расходов предыдущего дня считают строку текущего дня и решения для нее.
+    //
+    // Для каждого t нужны только prev[t-1], prev[t] и prev[t+1], между соседними t зависимостей нет,
+    // так что строку можно считать векторными min/add. Указатели prev и current указывают на t=0, при этом
+    // prev[-1] и prev[cells] обязаны существовать и содержать заведомо большое значение (сторожей), тогда
+    // крайние точки не требуют никаких отдельных проверок. Значения в строках всегда меньше 2^63, поэтому
+    // для сравнения uint64 можно использовать знаковые сравнения из SSE4.2/AVX2.
+    namespace row_kernels {
+        using Kernel = void (*)(
+            const std::uint64_t* prev,
+            std::uint64_t* current,
+            std::uint8_t* decisions,
+            const size_t cells,
+            const std::uint64_t price,
+            const bool is_gaining_ticket);
+
+        // Порядок проверок и строгие сравнения совпадают с порядком вариантов в std::min({...}), так что
+        // при равных расходах выбирается тот-же вариант что и раньше
+        inline auto scalarRange(
+            const std::uint64_t* prev,
+            std::uint64_t* current,
+            std::uint8_t* decisions,
+            const size_t from,
+            const size_t cells,
+            const std::uint64_t price,
+            const bool is_gaining_ticket) -> void
+        {
+            for (size_t t = from; t < cells; ++t) {
+                // Здесь не делаем никаких проверок, что приводит к тому что если мы получаем купон, то
+                // записывается фантомный вариант словно купон мы и не получили, но он абсолютно не влияет
+                // на результат вычислений, так как этот вариант в таком случае всегда будет проигрывать
+                // варианту когда мы тратим купон.
+                std::uint64_t expenses = prev[t] + price;
+                std::uint8_t decision = kTicketUnused;
+
+                if (is_gaining_ticket && prev[t-1] + price < expenses) {
+                    expenses = prev[t-1] + price;
+                    decision |= kTicketGained;
+                }
+                // Если мы тратим купон, то получается мы не прибавляем к расходам текущую цену
+                if (prev[t+1] < expenses) {
+                    expenses = prev[t+1];
+                    decision |= kTicketUsed;
+                }
+
+                current[t] = expenses;
+                decisions[t / DecisionsTable::kCellsPerByte] |=
+                    decision << (t % DecisionsTable::kCellsPerByte * DecisionsTable::kBitsPerCell);
+            }
+        }
+
+        inline auto scalar(
+            const std::uint64_t* prev,
+            std::uint64_t* current,
+            std::uint8_t* decisions,
+            const size_t cells,
+            const std::uint64_t price,
+            const bool is_gaining_ticket) -> void
+        {
+            scalarRange(prev, current, decisions, 0, cells, price, is_gaining_ticket);
+        }
+
+#if defined(__x86_64__) || defined(__i386__)
+        // Раскладывает 4 бита маски по четным позициям байта, что бы сложить маски двух
+        // вариантов в упакованные 2-х битные решения
+        constexpr auto kSpreadNibble = [](){
+            std::array<std::uint8_t, 16> table{};
+            for (size_t mask = 0; mask < table.size(); ++mask) {
+                for (size_t bit = 0; bit < 4; ++bit) {
+                    table[mask] |= ((mask >> bit) & 1u) << (bit * DecisionsTable::kBitsPerCell);
+                }
+            }
+            return table;
+        }();
+
+        constexpr auto packDecisions(const unsigned gained_mask, const unsigned used_mask) -> std::uint8_t {
+            return kSpreadNibble[gained_mask] | (kSpreadNibble[used_mask] << 1);
+        }
+
+        __attribute__((target("sse4.2")))
+        inline auto sse42(
+            const std::uint64_t* prev,
+            std::uint64_t* current,
+            std::uint8_t* decisions,
+            const size_t cells,
+            const std::uint64_t price,
+            const bool is_gaining_ticket) -> void
+        {
+            const __m128i price_v = _mm_set1_epi64x(static_cast<long long>(price));
+
+            size_t t = 0;
+            for (; t + 4 <= cells; t += 4) {
+                unsigned gained_mask = 0;
+                unsigned used_mask = 0;
+                for (size_t lane = 0; lane < 4; lane += 2) {
+                    __m128i best = _mm_add_epi64(_mm_loadu_si128(reinterpret_cast<const __m128i*>(prev + t + lane)), price_v);
+                    if (is_gaining_ticket) {
+                        const __m128i gained = _mm_add_epi64(_mm_loadu_si128(reinterpret_cast<const __m128i*>(prev + t + lane - 1)), price_v);
+                        const __m128i is_better = _mm_cmpgt_epi64(best, gained);
+                        best = _mm_blendv_epi8(best, gained, is_better);
+                        gained_mask |= _mm_movemask_pd(_mm_castsi128_pd(is_better)) << lane;
+                    }
+                    const __m128i used = _mm_loadu_si128(reinterpret_cast<const __m128i*>(prev + t + lane + 1));
+                    const __m128i is_better = _mm_cmpgt_epi64(best, used);
+                    best = _mm_blendv_epi8(best, used, is_better);
+                    used_mask |= _mm_movemask_pd(_mm_castsi128_pd(is_better)) << lane;
+                    _mm_storeu_si128(reinterpret_cast<__m128i*>(current + t + lane), best);
+                }
+                decisions[t / DecisionsTable::kCellsPerByte] = packDecisions(gained_mask, used_mask);
+            }
+            scalarRange(prev, current, decisions, t, cells, price, is_gaining_ticket);
+        }
+
+        __attribute__((target("avx2")))
+        inline auto avx2(
+            const std::uint64_t* prev,
+            std::uint64_t* current,
+            std::uint8_t* decisions,
+            const size_t cells,
+            const std::uint64_t price,
+            const bool is_gaining_ticket) -> void
+        {
+            const __m256i price_v = _mm256_set1_epi64x(static_cast<long long>(price));
+
+            size_t t = 0;
+            for (; t + 4 <= cells; t += 4) {
+                unsigned gained_mask = 0;
+                __m256i best = _mm256_add_epi64(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(prev + t)), price_v);
+                if (is_gaining_ticket) {
+                    const __m256i gained = _mm256_add_epi64(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(prev + t - 1)), price_v);
+                    const __m256i is_better = _mm256_cmpgt_epi64(best, gained);
+                    best = _mm256_blendv_epi8(best, gained, is_better);
+                    gained_mask = _mm256_movemask_pd(_mm256_castsi256_pd(is_better));
+                }
+                const __m256i used = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(prev + t + 1));
+                const __m256i is_better = _mm256_cmpgt_epi64(best, used);
+                best = _mm256_blendv_epi8(best, used, is_better);
+                const unsigned used_mask = _mm256_movemask_pd(_mm256_castsi256_pd(is_better));
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(current + t), best);
+                decisions[t / DecisionsTable::kCellsPerByte] = packDecisions(gained_mask, used_mask);
+            }
+            scalarRange(prev, current, decisions, t, cells, price, is_gaining_ticket);
+        }
+
+        __attribute__((target("avx512f")))
+        inline auto avx512(
+            const std::uint64_t* prev,
+            std::uint64_t* current,
+            std::uint8_t* decisions,
+            const size_t cells,
+            const std::uint64_t price,
+            const bool is_gaining_ticket) -> void
+        {
+            const __m512i price_v = _mm512_set1_epi64(static_cast<long long>(price));
+
+            size_t t = 0;
+            for (; t + 8 <= cells; t += 8) {
+                __mmask8 gained_mask = 0;
+                __m512i best = _mm512_add_epi64(_mm512_loadu_si512(prev + t), price_v);
+                if (is_gaining_ticket) {
+                    const __m512i gained = _mm512_add_epi64(_mm512_loadu_si512(prev + t - 1), price_v);
+                    gained_mask = _mm512_cmplt_epu64_mask(gained, best);
+                    best = _mm512_mask_blend_epi64(gained_mask, best, gained);
+                }
+                const __m512i used = _mm512_loadu_si512(prev + t + 1);
+                const __mmask8 used_mask = _mm512_cmplt_epu64_mask(used, best);
+                best = _mm512_mask_blend_epi64(used_mask, best, used);
+                _mm512_storeu_si512(current + t, best);
+
+                auto* packed = decisions + t / DecisionsTable::kCellsPerByte;
+                packed[0] = packDecisions(gained_mask & 0xf, used_mask & 0xf);
+                packed[1] = packDecisions(gained_mask >> 4, used_mask >> 4);
+            }
+            scalarRange(prev, current, decisions, t, cells, price, is_gaining_ticket);
+        }
+#endif
+
+        // Выбираем самое широкое ядро, которое поддерживает текущий процессор
+        inline auto select() -> Kernel {
+#if defined(__x86_64__) || defined(__i386__)
+            __builtin_cpu_init();
+            if (__builtin_cpu_supports("avx512f")) {
+                return avx512;
+            }
+            if (__builtin_cpu_supports("avx2")) {
+                return avx2;
+            }
+            if (__builtin_cpu_supports("sse4.2")) {
+                return sse42;
+            }
+#endif
+            return scalar;
+        }
+    }  // namespace row_kernels
+
+    // Решатель работает в онлайн режиме: цены подаются по одной через push(), а оптимальный
+    // результат на текущий момент можно получить в любой момент через currentResult(). Строка
+    // расходов растет на одну клетку только в дни, когда можно получить купон, так что память
+    // ограничена количеством купонов, а не дней. Если история использования купонов не нужна,
+    // то таблицу решений можно не хранить вовсе (History::kDrop).
     class Solver {
     public:
         struct Result {
@@ -46,137 +286,179 @@ namespace solution {
             std::uint64_t tickets_used;
         };
 
-        Solver() = default;
-        auto operator()(const std::vector<std::uint64_t>& prices, const std::uint64_t min_price_to_gain_a_ticket) -> Result;
+        enum class History : std::uint8_t {
+            kKeep,
+            kDrop,
+        };
 
-    private:
-        // В условии задано, что цена не может превышать 300, так что берем большое число с потолка,
-        // но которое не приводило бы к переполнению uint64 при kUndefinedPrice*2 (то есть при суммировании)
-        constexpr static std::uint64_t kUndefinedPrice = std::numeric_limits<std::uint32_t>::max();
+        explicit Solver(const std::uint64_t min_price_to_gain_a_ticket, const History history = History::kKeep);
 
-        struct Expenses {
-            std::uint64_t sum;
-            std::vector<std::uint64_t> days_with_used_tickets;
+        // Сбрасывает решатель к началу нового ряда цен. Уже выделенные буферы переиспользуются,
+        // так что один решатель может последовательно решать много задач без лишних аллокаций.
+        auto reset(const std::uint64_t min_price_to_gain_a_ticket) -> void;
+        auto push(const std::uint64_t price) -> void;
+        auto currentResult() const -> Result;
 
-            // В сравнении используем имеет смысл сравнивать только значения сумм расходов
-            auto operator<=>(const Expenses& rhs) const -> std::strong_ordering {
-                return sum <=> rhs.sum;
-            }
-        };
+    private:
+        // Так как строка растет вместе с количеством полученных купонов, недостижимых точек внутри
+        // строки почти не бывает и большое число нужно только для сторожей по краям строки. Берем его
+        // с запасом, что бы сторож плюс цена не доходил до 2^63 (см. ядра выше), а реальные суммы
+        // расходов даже на очень длинных потоках цен всегда оставались меньше него.
+        constexpr static std::uint64_t kUndefinedPrice = std::numeric_limits<std::uint64_t>::max() / 4;
 
         auto isGainingTicket(const std::uint64_t price) const -> bool;
-        auto makeDefaultExpenses() const -> Expenses;
-        auto makeDefaultExpensesOptions() const -> std::vector<Expenses>;
-        auto calculateMostOptimalExpenses(const size_t tickets_count, const size_t day) const -> Expenses;
+        auto getTicketsCells() const -> size_t;
+        auto addTicketsCell() -> void;
+        auto updateTicketsUsed(const std::uint8_t* day_decisions) -> void;
+        auto restoreDaysWithUsedTickets(size_t tickets_count) const -> std::vector<std::uint64_t>;
 
-        auto initBasicProperties(const std::vector<std::uint64_t>& prices, const std::uint64_t min_price_to_gain_a_ticket) -> void;
-        auto initCalculatedProperties() -> void;
+        // Ядро выбирается один раз под текущий процессор
+        const row_kernels::Kernel __row_kernel = row_kernels::select();
 
         // Изначальные свойства
-        std::uint64_t __min_price_to_gain_a_ticket = 0ull;
-        std::uint64_t __days_cout = 0ull;
-        std::vector<std::uint64_t> __prices;
-
-        // Вычисляемые свойства
-        std::uint64_t __max_tickets_count = 0ull;
-        // Свойства изменяемые во время решения
-        std::vector<Expenses> __previous_day_expenses_options;
+        std::uint64_t __min_price_to_gain_a_ticket;
+        const History __history;
+
+        // Свойства изменяемые во время решения. В строках по краям лежат сторожа, а варианту
+        // с t купонами соответствует элемент t+1.
+        std::uint64_t __days_count = 0ull;
+        std::vector<std::uint64_t> __previous_day_expenses_options;
+        std::vector<std::uint64_t> __current_day_expenses_options;
+        // Используются только при History::kKeep
+        DecisionsTable __decisions;
+        // Используются только при History::kDrop: решения текущего дня и количество
+        // потраченных купонов для каждого варианта
+        std::vector<std::uint8_t> __day_decisions;
+        std::vector<std::uint64_t> __previous_day_tickets_used;
+        std::vector<std::uint64_t> __current_day_tickets_used;
     };
 
-    auto Solver::initBasicProperties(
-        const std::vector<std::uint64_t>& prices,
-        const std::uint64_t min_price_to_gain_a_ticket) -> void
+    Solver::Solver(const std::uint64_t min_price_to_gain_a_ticket, const History history)
+        : __min_price_to_gain_a_ticket(min_price_to_gain_a_ticket)
+        , __history(history)
     {
+        reset(min_price_to_gain_a_ticket);
+    }
+
+    auto Solver::reset(const std::uint64_t min_price_to_gain_a_ticket) -> void {
         __min_price_to_gain_a_ticket = min_price_to_gain_a_ticket;
-        __days_cout = prices.size();
-        __prices = prices;
+        __days_count = 0;
+        __decisions.clear();
+
+        // До первого дня вариантов нет вовсе, а вариант без купонов заполнится первой ценой
+        __previous_day_expenses_options.assign(3, kUndefinedPrice);
+        __current_day_expenses_options.assign(3, kUndefinedPrice);
+        __previous_day_tickets_used.assign(3, 0);
+        __current_day_tickets_used.assign(3, 0);
     }
 
     auto Solver::isGainingTicket(const std::uint64_t price) const -> bool {
         return price >= __min_price_to_gain_a_ticket;
     }
 
-    auto Solver::makeDefaultExpenses() const -> Expenses {
-        return Expenses{
-            .sum = kUndefinedPrice,
-            .days_with_used_tickets = {}
-        };
+    auto Solver::getTicketsCells() const -> size_t {
+        return __previous_day_expenses_options.size() - 2;
     }
 
-    auto Solver::makeDefaultExpensesOptions() const -> std::vector<Expenses> {
-        return std::vector<Expenses>(
-            __max_tickets_count+1,
-            makeDefaultExpenses());
+    // Расширяем строки на одну клетку. Бывший правый сторож становится новой недостижимой
+    // клеткой, а справа от нее появляется новый сторож.
+    auto Solver::addTicketsCell() -> void {
+        __previous_day_expenses_options.emplace_back(kUndefinedPrice);
+        __current_day_expenses_options.emplace_back(kUndefinedPrice);
+        if (__history == History::kDrop) {
+            __previous_day_tickets_used.emplace_back(0);
+            __current_day_tickets_used.emplace_back(0);
+        }
     }
 
-    auto Solver::initCalculatedProperties() -> void {
-        // Считаем максимальное количество купонов которые мы можем получить
-        __max_tickets_count = std::count_if(
-            __prices.begin(),
-            __prices.end(),
-            [this](const auto p){
-                return this->isGainingTicket(p);
-            });
-
-        // По сути выставляем условия для нулевого дня, так как далее мы будем высчитывать все
-        // для последующих дней
-        __previous_day_expenses_options = makeDefaultExpensesOptions();
-        const auto first_price = __prices[0];
-        const auto initial_tickets_count = (isGainingTicket(first_price)) ? 1ull : 0ull;
-        __previous_day_expenses_options[initial_tickets_count].sum = first_price;
+    // Без таблицы решений количество потраченных купонов приходится вести для каждой клетки,
+    // следуя за решениями текущего дня
+    auto Solver::updateTicketsUsed(const std::uint8_t* day_decisions) -> void {
+        const auto* prev = __previous_day_tickets_used.data() + 1;
+        auto* current = __current_day_tickets_used.data() + 1;
+        for (size_t t = 0; t < getTicketsCells(); ++t) {
+            switch (DecisionsTable::decode(day_decisions, t)) {
+                case kTicketUsed:
+                    current[t] = prev[t+1] + 1;
+                    break;
+                case kTicketGained:
+                    current[t] = prev[t-1];
+                    break;
+                case kTicketUnused:
+                    current[t] = prev[t];
+                    break;
+            }
+        }
+        std::swap(__previous_day_tickets_used, __current_day_tickets_used);
     }
 
-    auto Solver::calculateMostOptimalExpenses(
-        const size_t tickets_count,
-        const size_t day) const -> Expenses
-    {
-        const std::uint64_t current_day_price = __prices[day];
-
-        // Если мы тратим купон, то получается мы не прибавляем к расходам текущую цену,
-        // но записываем что в этот день мы использовали купон
-        const auto get_expenses_if_ticket_was_used = [&](){
-            if (tickets_count != __max_tickets_count) {
-                auto expenses = __previous_day_expenses_options[tickets_count+1];
-                expenses.days_with_used_tickets.emplace_back(day+1);
-                return expenses;
-            }
-            return makeDefaultExpenses();
-        };
+    // С помощью методов динамического программирования будем искать
+    auto Solver::push(const std::uint64_t price) -> void {
+        const bool is_gaining_ticket = isGainingTicket(price);
+        if (is_gaining_ticket) {
+            addTicketsCell();
+        }
 
-        const auto get_expenses_if_ticket_was_gained = [&](){
-            if (isGainingTicket(current_day_price) && tickets_count > 0) {
-                auto expenses = __previous_day_expenses_options[tickets_count-1];
-                expenses.sum += current_day_price;
-                return expenses;
+        // По сути выставляем условия для нулевого дня, так как до него никаких вариантов
+        // расходов не существовало
+        if (__days_count == 0) {
+            __previous_day_expenses_options[is_gaining_ticket ? 2 : 1] = price;
+            if (__history == History::kKeep) {
+                __decisions.addDay(0);
             }
-            return makeDefaultExpenses();
-        };
+            __days_count += 1;
+            return;
+        }
 
-        // Здесь не делаем никаких проверок, что приводит к тому что если мы получаем купон, то
-        // записывается фантомный вариант словно купон мы и не получили, но он абсолютно не влияет
-        // на результат вычислений, так как этот функтор в таком случае всегда будет проигрывать
-        // варианту когда мы тратим купон.
-        const auto get_expenses_if_ticket_unused = [&](){
-            auto expenses = __previous_day_expenses_options[tickets_count];
-            expenses.sum += current_day_price;
-            return expenses;
-        };
+        // Для всех последующих дней расчитываем при помощи мемоизации оптимальные
+        // варианты на текущий день
+        const size_t cells = getTicketsCells();
+        std::uint8_t* day_decisions = nullptr;
+        if (__history == History::kKeep) {
+            day_decisions = __decisions.addDay(cells);
+        } else {
+            __day_decisions.assign(DecisionsTable::bytesForCells(cells), 0);
+            day_decisions = __day_decisions.data();
+        }
+
+        __row_kernel(
+            __previous_day_expenses_options.data() + 1,
+            __current_day_expenses_options.data() + 1,
+            day_decisions,
+            cells,
+            price,
+            is_gaining_ticket);
+        std::swap(__previous_day_expenses_options, __current_day_expenses_options);
+
+        if (__history == History::kDrop) {
+            updateTicketsUsed(day_decisions);
+        }
+        __days_count += 1;
+    }
 
-        return std::min({
-            get_expenses_if_ticket_unused(),
-            get_expenses_if_ticket_was_gained(),
-            get_expenses_if_ticket_was_used()});
+    // Идем от итоговой точки к первому дню по таблице решений и собираем дни, в которые
+    // использовался купон
+    auto Solver::restoreDaysWithUsedTickets(size_t tickets_count) const -> std::vector<std::uint64_t> {
+        std::vector<std::uint64_t> days_with_used_tickets;
+        for (size_t day = __days_count-1; day > 0; --day) {
+            switch (__decisions.get(day, tickets_count)) {
+                case kTicketUsed:
+                    days_with_used_tickets.emplace_back(day+1);
+                    tickets_count += 1;
+                    break;
+                case kTicketGained:
+                    tickets_count -= 1;
+                    break;
+                case kTicketUnused:
+                    break;
+            }
+        }
+        std::reverse(days_with_used_tickets.begin(), days_with_used_tickets.end());
+        return days_with_used_tickets;
     }
 
-    // С помощью методов динамического программирования будем искать
-    auto Solver::operator()(
-        const std::vector<std::uint64_t>& prices,
-        const std::uint64_t min_price_to_gain_a_ticket) -> Result
-    {
-        // Из-за присутствия у нас в коде такого понятия как варианты расходов для
-        // предыдущего дня, а мы расчитываем это перед основным циклом для первого дня,
-        // то нам надо бы иметь здесь такой костыль.
-        if (prices.size() == 0) {
+    auto Solver::currentResult() const -> Result {
+        if (__days_count == 0) {
             return Result{
                 .days_with_used_tickets={},
                 .expenses = 0,
@@ -185,41 +467,74 @@ namespace solution {
             };
         }
 
-        // Инициируем базовые свойства которые нужны для работы всех последующих методов
-        initBasicProperties(prices, min_price_to_gain_a_ticket);
-        // Иницируем вычисляемые свойства зависящие от предыдущих свойств, к примеру
-        // варианты расходов для предыдущего дня: $__previous_day_expenses_options
-        initCalculatedProperties();
-
-        // Для первого дня мы уже сделали нужные вычисления в предыдущей функции, так
-        // что обходим все последующие дни и расчитываем при помощи мемоизации оптимальные
-        // варианты на текущий день
-        for (size_t day = 1; day < __days_cout; ++day) {
-            std::vector<Expenses> current_day_expenses_options;
-            current_day_expenses_options.reserve(__max_tickets_count+1);
-            for (size_t t = 0; t < __max_tickets_count+1; ++t) {
-                current_day_expenses_options.emplace_back(calculateMostOptimalExpenses(t, day));
-            }
-            __previous_day_expenses_options = std::move(current_day_expenses_options);
-        }
-
-        // В итоговом дне находим такой варинат, у которого самые минимальные расходы. Притом мы используем >=
+        // В текущем дне находим такой варинат, у которого самые минимальные расходы. Притом мы используем >=
         // на случай если мы имеем одинаковое количество расходов, но вариант находящийся правее, это вариант
         // с большим количеством купонов.
+        const auto* last_day_expenses_options = __previous_day_expenses_options.data() + 1;
         size_t minimal_expenses_tickets = 0;
-        for (size_t t = 1; t < __max_tickets_count+1; ++t) {
-            if (__previous_day_expenses_options[minimal_expenses_tickets] >= __previous_day_expenses_options[t]) {
+        for (size_t t = 1; t < getTicketsCells(); ++t) {
+            if (last_day_expenses_options[minimal_expenses_tickets] >= last_day_expenses_options[t]) {
                 minimal_expenses_tickets = t;
             }
         }
-        auto& minimal = __previous_day_expenses_options[minimal_expenses_tickets];
+
+        if (__history == History::kDrop) {
+            return Result{
+                .days_with_used_tickets = {},
+                .expenses = last_day_expenses_options[minimal_expenses_tickets],
+                .tickets_remains = minimal_expenses_tickets,
+                .tickets_used = __previous_day_tickets_used[minimal_expenses_tickets+1],
+            };
+        }
+
+        auto days_with_used_tickets = restoreDaysWithUsedTickets(minimal_expenses_tickets);
+        const std::uint64_t tickets_used = days_with_used_tickets.size();
         return Result{
-            .days_with_used_tickets = minimal.days_with_used_tickets,
-            .expenses = minimal.sum,
+            .days_with_used_tickets = std::move(days_with_used_tickets),
+            .expenses = last_day_expenses_options[minimal_expenses_tickets],
             .tickets_remains = minimal_expenses_tickets,
-            .tickets_used = minimal.days_with_used_tickets.size(),
+            .tickets_used = tickets_used,
         };
     }
+
+    struct Job {
+        std::vector<std::uint64_t> prices;
+        std::uint64_t min_price_to_gain_a_ticket;
+    };
+
+    // Решает пачку независимых задач на нескольких потоках. Каждый поток держит свой решатель
+    // и забирает следующую задачу из общего счетчика, так что буферы строк переиспользуются
+    // между задачами одного потока, а длинные и короткие ряды сами собой балансируются.
+    // Потоков должен быть хотя бы один.
+    auto solveBatch(
+        const std::vector<Job>& jobs,
+        const size_t threads_count,
+        const Solver::History history
+    ) -> std::vector<Solver::Result> {
+        std::vector<Solver::Result> results(jobs.size());
+        std::atomic<size_t> next_job = 0;
+
+        const auto worker = [&]() {
+            Solver solver(0, history);
+            for (size_t job = next_job++; job < jobs.size(); job = next_job++) {
+                solver.reset(jobs[job].min_price_to_gain_a_ticket);
+                for (const auto price : jobs[job].prices) {
+                    solver.push(price);
+                }
+                results[job] = solver.currentResult();
+            }
+        };
+
+        std::vector<std::thread> workers;
+        workers.reserve(threads_count);
+        for (size_t i = 0; i < threads_count; ++i) {
+            workers.emplace_back(worker);
+        }
+        for (auto& w : workers) {
+            w.join();
+        }
+        return results;
+    }
 }  // namespace solution
 
 // Для решения заданой задачи будем использовать метод мемоизации. Нам важно рассмотреть
@@ -341,28 +656,95 @@ namespace solution {
 // вот и все!
 //
 // В программе данный метод реализуется через простую мемоизацию. Хранить нам надо только предыдущий день для
-// расчета текущего. Так-же в каждой точке карты надо бы сохранять историю использования купонов, что не меняет
-// нашего алгоритма. Для иксов в точках без значений, можно просто использовать просто такое то условное большое
+// расчета текущего. Для восстановления истории использования купонов в каждой точке карты достаточно запомнить
+// какой из трех вариантов был выбран (2 бита), а сами дни собрать одним проходом от итоговой точки назад. Для
+// иксов в точках без значений, можно просто использовать просто такое то условное большое
 // число, что бы оно всегда игнорировалось при выборе минимального значения.
 //
 // Динамическое программирование ВАН-ЛАВ
 
+auto printResult(const solution::Solver::Result& result) -> void {
+    auto& output = common::getStdout();
+    output.writeNumber(result.expenses).writeSeparator('\n');
+    output.writeNumber(result.tickets_remains).writeSeparator(' ').writeNumber(result.tickets_used).writeSeparator('\n');
+    for (auto x : result.days_with_used_tickets) {
+        output.writeNumber(x).writeSeparator('\n');
+    }
+}
+
+// Пакетный режим для прогона множества сценариев: cafe --batch FILE [--threads N]
+//
+// Формат файла: количество задач, а затем для каждой задачи количество дней, порог цены
+// для получения купона и сами цены. Результаты печатаются в порядке задач в том же формате,
+// что и в обычном режиме, а пропускная способность пишется в stderr.
+auto runBatch(const std::string& path, const size_t threads_count, const solution::Solver::History history) -> void {
+    common::InputReader input(path);
+
+    const auto jobs_count = common::getFromInput<size_t>(input);
+    std::vector<solution::Job> jobs(jobs_count);
+    for (auto& job : jobs) {
+        const auto days_count = common::getFromInput<size_t>(input);
+        job.min_price_to_gain_a_ticket = common::getFromInput<std::uint64_t>(input);
+        job.prices.reserve(days_count);
+        for (size_t day = 0; day < days_count; ++day) {
+            job.prices.emplace_back(common::getFromInput<std::uint64_t>(input));
+        }
+    }
+
+    const auto started = std::chrono::steady_clock::now();
+    const auto results = solution::solveBatch(jobs, threads_count, history);
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - started;
+
+    for (const auto& result : results) {
+        printResult(result);
+    }
+    common::getStdout().flush();
+    std::cerr << "solved " << jobs.size() << " cases on " << threads_count << " threads in "
+              << elapsed.count() << "s (" << (jobs.size() / std::max(elapsed.count(), 1e-9)) << " cases/s)"
+              << std::endl;
+}
+
 // https://coderun.yandex.ru/problem/cafe
-auto main() -> int {
+//
+// Флаги:
+//   --binary    - числа результата пишутся в stdout как int64 в little-endian, без разделителей
+//   --cost-only - печатать только расходы и количество купонов, без дней их использования;
+//                 таблица решений тогда не хранится и память ограничена количеством купонов
+auto main(int argc, char** argv) -> int {
+    const std::vector<std::string> args(argv + 1, argv + argc);
+    auto history = solution::Solver::History::kKeep;
+    std::string batch_path;
+    size_t threads_count = std::max(std::thread::hardware_concurrency(), 1u);
+    bool is_threads_count_set = false;
+    for (size_t i = 0; i < args.size(); ++i) {
+        if (args[i] == "--binary") {
+            common::getStdout().setFormat(common::OutputWriter::Format::kBinary);
+        } else if (args[i] == "--cost-only") {
+            history = solution::Solver::History::kDrop;
+        } else if (args[i] == "--batch" && i + 1 < args.size()) {
+            batch_path = args[++i];
+        } else if (args[i] == "--threads" && i + 1 < args.size()) {
+            threads_count = std::max<size_t>(std::stoul(args[++i]), 1);
+            is_threads_count_set = true;
+        } else {
+            throw std::invalid_argument("Unknown argument: " + args[i]);
+        }
+    }
+    if (!batch_path.empty()) {
+        runBatch(batch_path, threads_count, history);
+        return 0;
+    }
+    if (is_threads_count_set) {
+        throw std::invalid_argument("Usage: cafe [--binary] [--cost-only] [--batch FILE [--threads N]]");
+    }
+
     const auto days_count = common::getFromStdin<std::uint64_t>();
-    const auto prices = common::getFromStdin<std::vector<uint64_t>>(days_count);
     const std::uint64_t min_price_to_gain_a_ticket = 101;
 
-    auto [
-        tickets_history,
-        expenses,
-        tickets_remains,
-        tickets_used
-    ] = solution::Solver()(prices, min_price_to_gain_a_ticket);
-
-    std::cout << expenses << std::endl;;
-    std::cout << tickets_remains << " " << tickets_used << std::endl;;
-    for (auto x : tickets_history) {
-        std::cout << x << std::endl;
+    // Цены не копим, а сразу отдаем решателю по мере чтения
+    solution::Solver solver(min_price_to_gain_a_ticket, history);
+    for (std::uint64_t day = 0; day < days_count; ++day) {
+        solver.push(common::getFromStdin<std::uint64_t>());
     }
+    printResult(solver.currentResult());
 }
@@ -0,0 +1,24 @@
+#!/bin/bash
+# Проверки cafe на маленьких входах: test.sh ПУТЬ_К_ПРОГРАММЕ
+set -u
+bin=$1
+source "$(dirname "$0")/../common/test.sh"
+
+check "example" $'6\n35 40 101 59 63 5\n' $'240\n0 1\n5'
+check "two tickets" $'5\n110 40 120 110 60\n' $'260\n0 2\n3\n5'
+check "batch" $'2\n6 101\n35 40 101 59 63 5\n5 101\n110 40 120 110 60\n' $'240\n0 1\n5\n260\n0 2\n3\n5' \
+    --batch /dev/stdin --threads 2
+
+# Цены беззнаковые: минус - ошибка ввода, а не цена около 2^64, как было с std::cin
+checkError "negative price" $'2\n-5 7\n' "Failed to read value from stdin"
+
+# Без таблицы решений печатаются только расходы и купоны, и они те же, что и с таблицей
+check "cost only" $'6\n35 40 101 59 63 5\n' $'240\n0 1' --cost-only
+check "cost only two tickets" $'5\n110 40 120 110 60\n' $'260\n0 2' --cost-only
+check "cost only batch" $'2\n6 101\n35 40 101 59 63 5\n5 101\n110 40 120 110 60\n' $'240\n0 1\n260\n0 2' \
+    --cost-only --batch /dev/stdin --threads 2
+
+# Ноль потоков означает один, и в отчете тоже
+checkLog "zero threads" $'1\n6 101\n35 40 101 59 63 5\n' "on 1 threads" --batch /dev/stdin --threads 0
+
+finish
@@ -1,116 +1,548 @@
+#include <algorithm>
+#include <atomic>
+#include <concepts>
 #include <cstdint>
-#include <iostream>
-#include <iterator>
-#include <vector>
-#include <stack>
+#include <limits>
+#include <numeric>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <tuple>
 #include <utility>
+#include <vector>
+
+#include "common/csr_graph.h"
+#include "common/input.h"
+#include "common/output.h"
+#include "common/thread_pool.h"
 
 namespace common {
-    template <typename Value>
-    auto getFromStdin() -> Value {
-        Value var;
-        std::cin >> var;
-        if (!std::cin.good()) {
-            throw std::runtime_error("Failed to read value from stdin");
-        }
-        return var;
-    }
+    // Упакованный массив бит, по биту на элемент
+    class BitSet {
+    public:
+        explicit BitSet(const size_t size)
+            : __words((size + kWordBits - 1) / kWordBits, 0)
+        {
+        }
 
-    template <
-        typename Handler,
-        typename ... HandlerCustomArgs
-    >
-    auto traverse(
-        std::tuple<HandlerCustomArgs...>&& initial_params,
-        Handler handler
-    ) -> void {
-        using TraveseStackItem = std::tuple<HandlerCustomArgs...>;
-        std::stack<TraveseStackItem> traversing_stack;
-        traversing_stack.emplace(std::move(initial_params));
-
-        auto pusher = [&traversing_stack](HandlerCustomArgs ... args){
-            traversing_stack.emplace(std::forward_as_tuple(args...));
-        };
+        auto test(const size_t i) const -> bool {
+            return (__words[i / kWordBits] >> (i % kWordBits)) & 1;
+        }
 
-        while (!traversing_stack.empty()) {
-            const auto params = std::tuple_cat(
-                std::make_tuple(pusher),
-                traversing_stack.top());
-            traversing_stack.pop();
-            std::apply(handler, params);
+        auto set(const size_t i) -> void {
+            __words[i / kWordBits] |= std::uint64_t{1} << (i % kWordBits);
         }
-    }
+
+    private:
+        constexpr static size_t kWordBits = 64;
+
+        std::vector<std::uint64_t> __words;
+    };
 }  // namespace common
 
 namespace solution {
     using NodeID = std::uint64_t;
     using Edge = std::tuple<NodeID, NodeID>;
 
-    enum class Group : std::uint8_t {
-        kUnvisited = 0,
-        kFirst = 1,
-        kSecond = 2
-    };
+    // Вершины и ребра хранятся в самом узком типе, в который влезают номера вершин и ссылки CSR
+    template <std::unsigned_integral Node>
+    using BasicEdge = std::tuple<Node, Node>;
+
+    // Раскраска в два цвета обходом в ширину по CSR.
+    //
+    // Очередь - один заранее выделенный массив на все вершины: вершина попадает в него ровно один раз,
+    // когда ее красят, так что обходы всех компонент просто продолжают заполнять его дальше. Цвета
+    // упакованы по биту на вершину: отдельно "покрашена" и сам цвет. Первое же ребро между вершинами
+    // одного цвета означает нечетный цикл, и обход сразу прекращается.
+    template <std::unsigned_integral Node>
+    auto isBipartite(const common::CsrGraph<Node>& graph) -> bool {
+        const size_t nodes_count = graph.getNodesCount();
+        common::BitSet is_coloured(nodes_count);
+        common::BitSet is_second_group(nodes_count);
+        std::vector<Node> queue(nodes_count);
+        size_t queue_head = 0;
+        size_t queue_tail = 0;
 
-    constexpr auto getDifferentGroup(const Group g) -> Group {
-        switch (g) {
-            case Group::kUnvisited:
-            case Group::kSecond:
-                return Group::kFirst;
-            case Group::kFirst:
-                return Group::kSecond;
+        for (size_t root = 0; root < nodes_count; ++root) {
+            if (is_coloured.test(root)) {
+                continue;
+            }
+            is_coloured.set(root);
+            queue[queue_tail++] = root;
+            while (queue_head != queue_tail) {
+                const Node current_node = queue[queue_head++];
+                const bool group = is_second_group.test(current_node);
+                for (const Node next_node : graph.getNeighbours(current_node)) {
+                    if (!is_coloured.test(next_node)) {
+                        is_coloured.set(next_node);
+                        if (!group) {
+                            is_second_group.set(next_node);
+                        }
+                        queue[queue_tail++] = next_node;
+                    } else if (is_second_group.test(next_node) == group) {
+                        return false;
+                    }
+                }
+            }
         }
+        return true;
     }
 
-    auto solve(const std::size_t nodes_count, const std::vector<Edge>& edges) -> bool {
-        std::vector<std::vector<NodeID>> nodes_connections(nodes_count);
-        std::vector<Group> nodes_group(nodes_count, Group::kUnvisited);
- 
-        for (const auto& [node_one, node_two] : edges) {
-            nodes_connections[node_one].emplace_back(node_two);
-            nodes_connections[node_two].emplace_back(node_one);
-        }
-
-        bool is_groupped = true;
-        for (NodeID node = 0; node < nodes_count; ++node) {
-            common::traverse(
-                std::make_tuple(
-                    node,
-                    Group::kUnvisited
-                ),
-                [&](
-                    auto traverse_pusher,
-                    const NodeID current_node,
-                    const Group previous_group
-                ){
-                    if (auto& group = nodes_group[current_node]; group == Group::kUnvisited) {
-                        group = getDifferentGroup(previous_group);
-                        for (const auto next_node : nodes_connections[current_node]) {
-                            traverse_pusher(next_node, group);
+    // Система непересекающихся множеств с четностью. Для вершины хранится четность ребра до родителя,
+    // так что четность пути до корня - это xor по пути, а вершины одного множества в одной доле, если
+    // их четности до корня совпадают. Объединение по размеру, сжатие путей делением пополам.
+    template <std::unsigned_integral Node>
+    class ParityDisjointSets {
+    public:
+        enum class UniteResult {
+            kMerged,
+            kSameGroups,
+            kOddCycle,
+        };
+
+        explicit ParityDisjointSets(const size_t nodes_count)
+            : __parents(nodes_count)
+            , __sizes(nodes_count, 1)
+            , __parities(nodes_count, 0)
+        {
+            std::iota(__parents.begin(), __parents.end(), Node{0});
+        }
+
+        // Корень множества и четность пути до него
+        auto find(Node node) -> std::pair<Node, bool> {
+            bool parity = false;
+            while (__parents[node] != node) {
+                const Node parent = __parents[node];
+                __parities[node] ^= __parities[parent];
+                __parents[node] = __parents[parent];
+                parity ^= __parities[node];
+                node = __parents[node];
+            }
+            return {node, parity};
+        }
+
+        // Ограничение "вершины в разных долях" (как у ребра) или, если is_different = false, "в одной"
+        auto unite(const Node one, const Node two, const bool is_different = true) -> UniteResult {
+            auto [big, big_parity] = find(one);
+            auto [small, small_parity] = find(two);
+            if (big == small) {
+                return (big_parity != small_parity) == is_different ? UniteResult::kSameGroups : UniteResult::kOddCycle;
+            }
+            if (__sizes[big] < __sizes[small]) {
+                std::swap(big, small);
+            }
+            __parents[small] = big;
+            __parities[small] = big_parity ^ small_parity ^ is_different;
+            __sizes[big] += __sizes[small];
+            return UniteResult::kMerged;
+        }
+
+    private:
+        std::vector<Node> __parents;
+        std::vector<Node> __sizes;
+        std::vector<std::uint8_t> __parities;
+    };
+
+    // Проверка двудольности по одному ребру за раз без хранения графа: памяти O(вершин). Чтобы
+    // предъявить нечетный цикл, дополнительно запоминаются ребра остовного леса (их меньше, чем
+    // вершин): цикл - это путь по лесу между концами плохого ребра плюс само ребро.
+    template <std::unsigned_integral Node>
+    class OnlineBipartiteChecker {
+    public:
+        OnlineBipartiteChecker(const size_t nodes_count, const bool is_keeping_forest)
+            : __sets(nodes_count)
+            , __nodes_count(nodes_count)
+            , __is_keeping_forest(is_keeping_forest)
+        {
+        }
+
+        // Возвращает false, если ребро замкнуло нечетный цикл
+        auto add(const Node one, const Node two) -> bool {
+            if (one >= __nodes_count || two >= __nodes_count) {
+                throw std::out_of_range("edge node id is out of range");
+            }
+            switch (__sets.unite(one, two)) {
+                case ParityDisjointSets<Node>::UniteResult::kMerged:
+                    if (__is_keeping_forest) {
+                        __forest.emplace_back(one, two);
+                    }
+                    return true;
+                case ParityDisjointSets<Node>::UniteResult::kSameGroups:
+                    return true;
+                case ParityDisjointSets<Node>::UniteResult::kOddCycle:
+                    return false;
+            }
+            return false;
+        }
+
+        // Нечетный цикл через ребро (one, two), на котором add вернул false: вершины по порядку от one
+        // до two, последнее ребро цикла - само (one, two)
+        auto getOddCycle(const Node one, const Node two) const -> std::vector<Node> {
+            if (!__is_keeping_forest) {
+                throw std::logic_error("spanning forest is not kept");
+            }
+            const common::CsrGraph<Node> forest(__nodes_count, __forest);
+            constexpr Node kNoParent = std::numeric_limits<Node>::max();
+            std::vector<Node> parents(__nodes_count, kNoParent);
+            std::vector<Node> queue{two};
+            parents[two] = two;
+            for (size_t head = 0; head < queue.size() && parents[one] == kNoParent; ++head) {
+                for (const Node next_node : forest.getNeighbours(queue[head])) {
+                    if (parents[next_node] == kNoParent) {
+                        parents[next_node] = queue[head];
+                        queue.emplace_back(next_node);
+                    }
+                }
+            }
+
+            std::vector<Node> cycle{one};
+            while (cycle.back() != two) {
+                cycle.emplace_back(parents[cycle.back()]);
+            }
+            return cycle;
+        }
+
+    private:
+        ParityDisjointSets<Node> __sets;
+        const size_t __nodes_count;
+        const bool __is_keeping_forest;
+        std::vector<BasicEdge<Node>> __forest;
+    };
+    // Параллельная раскраска поуровневым обходом в ширину из многих источников сразу.
+    //
+    // Метка вершины - источник, из которого ее достиг обход, и четность глубины в его дереве, в одном
+    // атомарном слове, так что метка и четность появляются одновременно и больше не меняются. Обход
+    // идет раундами: в каждом раунде каждый кусок вершин выбирает источники среди своих еще не
+    // достигнутых вершин (в следующем раунде вдвое больше), так что все компоненты красятся
+    // одновременно, а мелкие добираются за логарифм раундов. Уровни обходятся либо сверху вниз (вершины
+    // фронта захватывают соседей через CAS), либо, когда фронт покрывает заметную часть
+    // непросмотренных ребер, снизу вверх (каждая недостигнутая вершина ищет уже достигнутого соседа)
+    // по эвристике Beamer et al.
+    //
+    // Ребро между вершинами одного дерева с одинаковой четностью глубины замыкает нечетный цикл. Такие
+    // ребра ловятся уже при обходе сверху вниз, и тогда все потоки сразу прекращают работу. В конце
+    // параллельно проверяются все ребра, а ребра между деревьями разных источников дают ограничения на
+    // взаимную четность источников, которые разрешаются системой множеств с четностью.
+    template <std::unsigned_integral Node>
+    class ParallelBipartiteChecker {
+    public:
+        ParallelBipartiteChecker(const common::CsrGraph<Node>& graph, common::ThreadPool& pool)
+            : __graph(graph)
+            , __pool(pool)
+            , __labels(graph.getNodesCount())
+            , __cursors(getChunksCount(graph.getNodesCount()))
+        {
+            for (auto& label : __labels) {
+                label.store(kUnvisited, std::memory_order_relaxed);
+            }
+            for (size_t chunk = 0; chunk < __cursors.size(); ++chunk) {
+                __cursors[chunk] = chunk * kChunkNodes;
+            }
+            for (size_t node = 0; node < graph.getNodesCount(); ++node) {
+                __unexplored_edges += graph.getNeighbours(node).size();
+            }
+        }
+
+        auto operator()() -> bool {
+            const size_t nodes_count = __graph.getNodesCount();
+            for (size_t seeds_per_chunk = 1; claimSeeds(seeds_per_chunk); seeds_per_chunk *= 2) {
+                bool is_bottom_up = false;
+                while (!__frontier.empty()) {
+                    if (!is_bottom_up && __frontier_edges > __unexplored_edges / kTopDownToBottomUp) {
+                        is_bottom_up = true;
+                    } else if (is_bottom_up && __frontier.size() < nodes_count / kBottomUpToTopDown) {
+                        is_bottom_up = false;
+                    }
+                    if (is_bottom_up) {
+                        stepBottomUp();
+                    } else {
+                        stepTopDown();
+                    }
+                    if (__has_conflict.load(std::memory_order_relaxed)) {
+                        return false;
+                    }
+                }
+            }
+            return checkEdges();
+        }
+
+    private:
+        using Label = std::uint64_t;
+
+        constexpr static Label kUnvisited = std::numeric_limits<Label>::max();
+        constexpr static size_t kChunkNodes = size_t{1} << 12;
+        // Параметры alpha и beta переключения направления из статьи Beamer et al.
+        constexpr static size_t kTopDownToBottomUp = 15;
+        constexpr static size_t kBottomUpToTopDown = 18;
+
+        static auto getChunksCount(const size_t count) -> size_t {
+            return (count + kChunkNodes - 1) / kChunkNodes;
+        }
+
+        static auto getSeed(const Label label) -> Node {
+            return label >> 1;
+        }
+
+        // Каждый кусок вершин выбирает до seeds_per_chunk источников среди своих недостигнутых вершин
+        auto claimSeeds(const size_t seeds_per_chunk) -> bool {
+            const size_t nodes_count = __graph.getNodesCount();
+            resetChunkFrontiers(__cursors.size());
+            __pool.run(__cursors.size(), [&](const size_t chunk) {
+                const size_t chunk_end = std::min((chunk + 1) * kChunkNodes, nodes_count);
+                auto& cursor = __cursors[chunk];
+                for (size_t claimed = 0; cursor < chunk_end && claimed < seeds_per_chunk; ++cursor) {
+                    if (__labels[cursor].load(std::memory_order_relaxed) == kUnvisited) {
+                        __labels[cursor].store(Label{cursor} << 1, std::memory_order_relaxed);
+                        pushToFrontier(chunk, cursor);
+                        ++claimed;
+                    }
+                }
+            });
+            gatherFrontier();
+            return !__frontier.empty();
+        }
+
+        auto stepTopDown() -> void {
+            const std::vector<Node> frontier = std::move(__frontier);
+            resetChunkFrontiers(getChunksCount(frontier.size()));
+            __pool.run(__chunk_frontiers.size(), [&](const size_t chunk) {
+                const size_t chunk_end = std::min((chunk + 1) * kChunkNodes, frontier.size());
+                for (size_t i = chunk * kChunkNodes; i < chunk_end; ++i) {
+                    if (__has_conflict.load(std::memory_order_relaxed)) {
+                        return;
+                    }
+                    const Node current_node = frontier[i];
+                    const Label label = __labels[current_node].load(std::memory_order_relaxed);
+                    for (const Node next_node : __graph.getNeighbours(current_node)) {
+                        Label next_label = __labels[next_node].load(std::memory_order_relaxed);
+                        if (next_label == kUnvisited) {
+                            if (__labels[next_node].compare_exchange_strong(
+                                    next_label, label ^ 1, std::memory_order_relaxed)) {
+                                pushToFrontier(chunk, next_node);
+                                continue;
+                            }
+                        }
+                        if (next_label == label) {
+                            __has_conflict.store(true, std::memory_order_relaxed);
+                            return;
                         }
-                    } else if (group != getDifferentGroup(previous_group) && previous_group != Group::kUnvisited) {
-                        is_groupped = false;
                     }
-                });
+                }
+            });
+            gatherFrontier();
         }
-        return is_groupped;
+
+        // Недостигнутую вершину захватывает только поток ее куска, так что CAS не нужен. Соседом
+        // может оказаться и вершина, достигнутая на этом же шаге: она все равно годится в родители.
+        auto stepBottomUp() -> void {
+            const size_t nodes_count = __graph.getNodesCount();
+            resetChunkFrontiers(getChunksCount(nodes_count));
+            __pool.run(__chunk_frontiers.size(), [&](const size_t chunk) {
+                const size_t chunk_end = std::min((chunk + 1) * kChunkNodes, nodes_count);
+                for (size_t node = __cursors[chunk]; node < chunk_end; ++node) {
+                    if (__labels[node].load(std::memory_order_relaxed) != kUnvisited) {
+                        continue;
+                    }
+                    for (const Node parent : __graph.getNeighbours(node)) {
+                        if (const Label label = __labels[parent].load(std::memory_order_relaxed); label != kUnvisited) {
+                            __labels[node].store(label ^ 1, std::memory_order_relaxed);
+                            pushToFrontier(chunk, node);
+                            break;
+                        }
+                    }
+                }
+            });
+            gatherFrontier();
+        }
+
+        // Ребра внутри одного дерева проверяются сразу, а между деревьями собираются как ограничения
+        // на четности источников и затем разрешаются последовательно
+        auto checkEdges() -> bool {
+            using Constraint = std::tuple<Node, Node, bool>;
+            const size_t nodes_count = __graph.getNodesCount();
+            std::vector<std::vector<Constraint>> constraints(getChunksCount(nodes_count));
+            __pool.run(constraints.size(), [&](const size_t chunk) {
+                const size_t chunk_end = std::min((chunk + 1) * kChunkNodes, nodes_count);
+                for (size_t node = chunk * kChunkNodes; node < chunk_end; ++node) {
+                    if (__has_conflict.load(std::memory_order_relaxed)) {
+                        return;
+                    }
+                    const Label label = __labels[node].load(std::memory_order_relaxed);
+                    for (const Node next_node : __graph.getNeighbours(node)) {
+                        if (next_node < node) {
+                            continue;
+                        }
+                        const Label next_label = __labels[next_node].load(std::memory_order_relaxed);
+                        if (label == next_label) {
+                            __has_conflict.store(true, std::memory_order_relaxed);
+                            return;
+                        }
+                        if (getSeed(label) == getSeed(next_label)) {
+                            continue;
+                        }
+                        const Constraint constraint(getSeed(label), getSeed(next_label), ((label ^ next_label ^ 1) & 1) != 0);
+                        if (constraints[chunk].empty() || constraints[chunk].back() != constraint) {
+                            constraints[chunk].emplace_back(constraint);
+                        }
+                    }
+                }
+            });
+            if (__has_conflict.load(std::memory_order_relaxed)) {
+                return false;
+            }
+
+            ParityDisjointSets<Node> seeds(nodes_count);
+            for (const auto& chunk_constraints : constraints) {
+                for (const auto& [one, two, is_different] : chunk_constraints) {
+                    if (seeds.unite(one, two, is_different) == ParityDisjointSets<Node>::UniteResult::kOddCycle) {
+                        return false;
+                    }
+                }
+            }
+            return true;
+        }
+
+        auto resetChunkFrontiers(const size_t chunks_count) -> void {
+            __chunk_frontiers.resize(chunks_count);
+            __chunk_edges.assign(chunks_count, 0);
+            for (auto& chunk_frontier : __chunk_frontiers) {
+                chunk_frontier.clear();
+            }
+        }
+
+        auto pushToFrontier(const size_t chunk, const Node node) -> void {
+            __chunk_frontiers[chunk].emplace_back(node);
+            __chunk_edges[chunk] += __graph.getNeighbours(node).size();
+        }
+
+        auto gatherFrontier() -> void {
+            __frontier.clear();
+            __frontier_edges = 0;
+            for (size_t chunk = 0; chunk < __chunk_frontiers.size(); ++chunk) {
+                __frontier.insert(__frontier.end(), __chunk_frontiers[chunk].begin(), __chunk_frontiers[chunk].end());
+                __frontier_edges += __chunk_edges[chunk];
+            }
+            __unexplored_edges -= __frontier_edges;
+        }
+
+        const common::CsrGraph<Node>& __graph;
+        common::ThreadPool& __pool;
+        std::vector<std::atomic<Label>> __labels;
+        // Все вершины куска до курсора уже достигнуты
+        std::vector<size_t> __cursors;
+        std::vector<Node> __frontier;
+        std::vector<std::vector<Node>> __chunk_frontiers;
+        std::vector<size_t> __chunk_edges;
+        size_t __frontier_edges = 0;
+        size_t __unexplored_edges = 0;
+        std::atomic<bool> __has_conflict = false;
+    };
+
+    // С пулом потоков граф красится параллельно, без него обычным обходом в ширину
+    template <std::unsigned_integral Node>
+    auto solve(
+        const std::size_t nodes_count,
+        const std::vector<BasicEdge<Node>>& edges,
+        common::ThreadPool* pool = nullptr) -> bool
+    {
+        const common::CsrGraph<Node> graph(nodes_count, edges);
+        if (pool != nullptr) {
+            return ParallelBipartiteChecker<Node>(graph, *pool)();
+        }
+        return isBipartite(graph);
     }
 }  // namespace solution
 
+template <std::unsigned_integral Node>
+auto run(const size_t nodes_count, const size_t edges_count, common::ThreadPool* pool) -> bool {
+    std::vector<solution::BasicEdge<Node>> edges;
+    edges.reserve(edges_count);
+
+    for (size_t edge = 0; edge < edges_count; ++edge) {
+        const auto one = common::getFromStdin<Node>() - 1;
+        const auto two = common::getFromStdin<Node>() - 1;
+        edges.emplace_back(one, two);
+    }
+
+    return solution::solve(nodes_count, edges, pool);
+}
+
+// Ребра читаются и проверяются по одному, чтение прекращается на первом плохом ребре. Печатает YES,
+// либо NO и номер первого ребра (с единицы), замкнувшего нечетный цикл, и, если нужно, сам цикл.
+template <std::unsigned_integral Node>
+auto runOnline(const size_t nodes_count, const size_t edges_count, const bool is_witness_needed) -> void {
+    solution::OnlineBipartiteChecker<Node> checker(nodes_count, is_witness_needed);
+    for (size_t edge = 0; edge < edges_count; ++edge) {
+        const auto one = common::getFromStdin<Node>() - 1;
+        const auto two = common::getFromStdin<Node>() - 1;
+        if (checker.add(one, two)) {
+            continue;
+        }
+        auto& output = common::getStdout();
+        output.writeText("NO").writeSeparator('\n').writeNumber(edge + 1).writeSeparator('\n');
+        if (is_witness_needed) {
+            for (const Node node : checker.getOddCycle(one, two)) {
+                output.writeNumber(std::uint64_t{node} + 1).writeSeparator(' ');
+            }
+            output.writeSeparator('\n');
+        }
+        return;
+    }
+    common::getStdout().writeText("YES").writeSeparator('\n');
+}
+
 // https://coderun.yandex.ru/problem/cheating
-auto main() -> int {
+//
+// Флаги:
+//   --online    - проверять ребра по мере чтения, не храня граф; при ответе NO вторая строка -
+//                 номер первого ребра, после которого граф перестал быть двудольным
+//   --witness   - то же, что --online, плюс третья строка с вершинами нечетного цикла
+//   --parallel  - параллельная раскраска обходом в ширину по уровням
+//   --threads N - количество потоков для --parallel (по умолчанию все ядра)
+//   --binary    - числа ответа пишутся как int64 в little-endian, без разделителей
+auto main(int argc, char** argv) -> int {
+    const std::vector<std::string> args(argv + 1, argv + argc);
+    bool is_online = false;
+    bool is_witness_needed = false;
+    bool is_parallel = false;
+    size_t threads_count = std::max(std::thread::hardware_concurrency(), 1u);
+    for (size_t i = 0; i < args.size(); ++i) {
+        if (args[i] == "--online") {
+            is_online = true;
+        } else if (args[i] == "--witness") {
+            is_online = true;
+            is_witness_needed = true;
+        } else if (args[i] == "--parallel") {
+            is_parallel = true;
+        } else if (args[i] == "--threads" && i + 1 < args.size()) {
+            threads_count = std::max<size_t>(std::stoul(args[++i]), 1);
+        } else if (args[i] == "--binary") {
+            common::getStdout().setFormat(common::OutputWriter::Format::kBinary);
+        } else {
+            throw std::invalid_argument("Usage: cheating [--online] [--witness] [--parallel] [--threads N] [--binary]");
+        }
+    }
+
     const auto nodes_count = common::getFromStdin<std::size_t>();
     const auto edges_count = common::getFromStdin<std::size_t>();
 
-    std::vector<solution::Edge> edges;
-    edges.reserve(edges_count);
-
-    for (size_t edge = 0; edge < edges_count; ++edge) {
-        edges.emplace_back(
-            std::make_tuple(
-                common::getFromStdin<solution::NodeID>() - 1,
-                common::getFromStdin<solution::NodeID>() - 1));
+    const bool is_small = common::isCsrNodeTypeEnough<std::uint32_t>(nodes_count, edges_count);
+    if (is_online) {
+        if (is_small) {
+            runOnline<std::uint32_t>(nodes_count, edges_count, is_witness_needed);
+        } else {
+            runOnline<solution::NodeID>(nodes_count, edges_count, is_witness_needed);
+        }
+        return 0;
     }
 
-    std::cout << (solution::solve(nodes_count, edges) ? "YES" : "NO") << std::endl;
+    std::optional<common::ThreadPool> pool;
+    if (is_parallel) {
+        pool.emplace(threads_count);
+    }
+    const bool is_groupped = is_small
+        ? run<std::uint32_t>(nodes_count, edges_count, pool ? &*pool : nullptr)
+        : run<solution::NodeID>(nodes_count, edges_count, pool ? &*pool : nullptr);
+    common::getStdout().writeText(is_groupped ? "YES" : "NO").writeSeparator('\n');
 }
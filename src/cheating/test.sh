@@ -0,0 +1,59 @@
+#!/bin/bash
+# Проверки cheating на маленьких входах: test.sh ПУТЬ_К_ПРОГРАММЕ
+set -u
+bin=$1
+source "$(dirname "$0")/../common/test.sh"
+
+# cycle N - цикл из N вершин, ребра по порядку, последнее замыкает цикл
+cycle() {
+    awk -v n="$1" 'BEGIN { print n, n; for (i = 1; i <= n; ++i) print i, i % n + 1 }'
+}
+
+# complete N EXTRA - полный двудольный граф с долями 1..N и N+1..2N, плюс EXTRA ребер внутри первой доли
+complete() {
+    awk -v n="$1" -v extra="$2" 'BEGIN {
+        print 2 * n, n * n + extra
+        for (i = 1; i <= n; ++i) for (j = 1; j <= n; ++j) print i, n + j
+        for (i = 1; i <= extra; ++i) print i, i + 1
+    }'
+}
+
+path=$'3 2\n1 2\n2 3\n'
+triangle=$'3 3\n1 2\n2 3\n1 3\n'
+# Нечетный цикл 3-4-5 замыкается последним ребром, а 1-2 в другой компоненте
+late=$'5 5\n1 2\n3 4\n4 5\n1 5\n3 5\n'
+isolated=$'4 1\n1 2\n'
+even_cycle=$(cycle 20000)$'\n'
+odd_cycle=$(cycle 20001)$'\n'
+bipartite=$(complete 100 0)$'\n'
+extra_edge=$(complete 100 1)$'\n'
+
+# checkGraphs [АРГУМЕНТЫ...] - ответы на общих графах. Десятки тысяч вершин дают много уровней
+# обхода, а полный двудольный граф - широкий фронт.
+checkGraphs() {
+    check "path $*" "$path" "YES" "$@"
+    check "triangle $*" "$triangle" "NO" "$@"
+    check "late $*" "$late" "NO" "$@"
+    check "isolated $*" "$isolated" "YES" "$@"
+    check "even cycle $*" "$even_cycle" "YES" "$@"
+    check "odd cycle $*" "$odd_cycle" "NO" "$@"
+    check "complete bipartite $*" "$bipartite" "YES" "$@"
+    check "complete bipartite with extra edge $*" "$extra_edge" "NO" "$@"
+}
+
+checkGraphs
+checkGraphs --parallel --threads 3
+
+# Онлайн-режим печатает номер ребра, после которого граф перестал быть двудольным,
+# а с --witness еще и вершины нечетного цикла
+check "online path" "$path" "YES" --online
+check "online triangle" "$triangle" $'NO\n3' --online
+check "online late" "$late" $'NO\n5' --online
+check "online odd cycle" "$odd_cycle" $'NO\n20001' --online
+check "online extra edge" "$extra_edge" $'NO\n10001' --online
+check "witness triangle" "$triangle" $'NO\n3\n1 2 3 ' --witness
+check "witness late" "$late" $'NO\n5\n3 4 5 ' --witness
+check "witness extra edge" "$extra_edge" $'NO\n10001\n1 101 2 ' --witness
+check "witness path" "$path" "YES" --witness
+
+finish
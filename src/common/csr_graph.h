@@ -0,0 +1,60 @@
+#pragma once
+
+#include <concepts>
+#include <cstddef>
+#include <limits>
+#include <numeric>
+#include <span>
+#include <stdexcept>
+#include <vector>
+
+namespace common {
+    // Влезают ли номера вершин и ссылки CSR неориентированного графа в тип Node
+    template <std::unsigned_integral Node>
+    auto isCsrNodeTypeEnough(const size_t nodes_count, const size_t edges_count) -> bool {
+        constexpr size_t kMax = std::numeric_limits<Node>::max();
+        return nodes_count <= kMax && edges_count <= kMax / 2;
+    }
+
+    // Неориентированный граф в формате CSR: соседи вершины v лежат подряд в
+    // __neighbours[__offsets[v], __offsets[v+1]). Строится в два прохода по списку ребер: первый
+    // считает степени, второй раскладывает соседей. Вершины нумеруются с нуля, ребра - любые пары,
+    // которые раскладываются структурным связыванием.
+    template <std::unsigned_integral Node>
+    class CsrGraph {
+    public:
+        template <typename Edges>
+        CsrGraph(const size_t nodes_count, const Edges& edges)
+            : __offsets(nodes_count + 1, 0)
+        {
+            for (const auto& [one, two] : edges) {
+                if (one >= nodes_count || two >= nodes_count) {
+                    throw std::out_of_range("edge node id is out of range");
+                }
+                __offsets[one + 1] += 1;
+                __offsets[two + 1] += 1;
+            }
+            std::inclusive_scan(__offsets.begin(), __offsets.end(), __offsets.begin());
+
+            __neighbours.resize(__offsets.back());
+            std::vector<Node> positions(__offsets.begin(), __offsets.end() - 1);
+            for (const auto& [one, two] : edges) {
+                __neighbours[positions[one]++] = two;
+                __neighbours[positions[two]++] = one;
+            }
+        }
+
+        auto getNodesCount() const -> size_t {
+            return __offsets.size() - 1;
+        }
+
+        auto getNeighbours(const Node node) const -> std::span<const Node> {
+            return std::span<const Node>(__neighbours).subspan(
+                __offsets[node], __offsets[node + 1] - __offsets[node]);
+        }
+
+    private:
+        std::vector<Node> __offsets;
+        std::vector<Node> __neighbours;
+    };
+}  // namespace common
@@ -0,0 +1,268 @@
+#pragma once
+
+#include <algorithm>
+#include <cerrno>
+#include <charconv>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace common {
+    // Пробельные символы в смысле std::isspace для локали "C", без обращения к локали
+    inline auto isSpace(const char c) -> bool {
+        constexpr std::uint64_t kSpaces =
+            (std::uint64_t{1} << ' ') | (std::uint64_t{1} << '\t') | (std::uint64_t{1} << '\n')
+            | (std::uint64_t{1} << '\v') | (std::uint64_t{1} << '\f') | (std::uint64_t{1} << '\r');
+        const auto code = static_cast<unsigned char>(c);
+        return code <= ' ' && ((kSpaces >> code) & 1) != 0;
+    }
+
+    // Ввод без iostream. Обычный файл (в том числе перенаправленный в stdin) отображается в память
+    // целиком, остальное - пайпы, терминал - читается через read(2) блоками по kBufferBytes. Числа
+    // разбираются std::from_chars прямо из отображения или буфера, без промежуточных строк.
+    class InputReader {
+    public:
+        constexpr static size_t kBufferBytes = size_t{1} << 20;
+
+        // Число читается, только когда оно целиком лежит в буфере: если до конца буфера меньше
+        // kMaxNumberChars байт и в них нет пробельного символа, буфер сначала дочитывается
+        constexpr static ptrdiff_t kMaxNumberChars = 64;
+
+        // Чтение из открытого дескриптора, который остается открытым и после
+        explicit InputReader(const int fd)
+            : __fd(fd)
+        {
+            init();
+        }
+
+        explicit InputReader(const std::string& path)
+            : __fd(::open(path.c_str(), O_RDONLY))
+            , __is_owning(true)
+        {
+            if (__fd < 0) {
+                throw std::system_error(errno, std::generic_category(), "failed to open " + path);
+            }
+            init();
+        }
+
+        InputReader(const InputReader&) = delete;
+        auto operator=(const InputReader&) -> InputReader& = delete;
+
+        ~InputReader() {
+            if (__mapping != nullptr) {
+                ::munmap(__mapping, __mapping_bytes);
+            }
+            if (__is_owning) {
+                ::close(__fd);
+            }
+        }
+
+        // Пропускает пробельные символы. Возвращает false, если ввод закончился.
+        auto skipSpaces() -> bool {
+            for (;;) {
+                while (__begin != __end && isSpace(*__begin)) {
+                    ++__begin;
+                }
+                if (__begin != __end) {
+                    return true;
+                }
+                if (!refill()) {
+                    return false;
+                }
+            }
+        }
+
+        // Как и operator>> у потоков, пропускает пробельные символы и читает число, допуская знак
+        // "+" перед ним. Возвращает false, если ввод закончился или там не число.
+        template <std::integral Number>
+        auto read(Number& number) -> bool {
+            if (!skipSpaces()) {
+                return false;
+            }
+            while (!__is_ended && __end - __begin < kMaxNumberChars && std::find_if(__begin, __end, isSpace) == __end) {
+                refill();
+            }
+            const char* current = __begin;
+            if (*current == '+') {
+                ++current;
+            }
+            const auto [next, error] = std::from_chars(current, __end, number);
+            if (error != std::errc{}) {
+                return false;
+            }
+            __begin = next;
+            return true;
+        }
+
+        // Следующий кусок текста не меньше bytes байт (если ввод не кончился раньше), который
+        // заканчивается на границе числа, так что куски можно разбирать независимо. Возвращает
+        // false, если ввод закончился.
+        auto readText(std::string& text, const size_t bytes) -> bool {
+            text.clear();
+            while (text.size() < bytes && (__begin != __end || refill())) {
+                const size_t taken = std::min(bytes - text.size(), static_cast<size_t>(__end - __begin));
+                text.append(__begin, taken);
+                __begin += taken;
+            }
+            for (;;) {
+                const char* const space = std::find_if(__begin, __end, isSpace);
+                text.append(__begin, space);
+                __begin = space;
+                if (__begin != __end || !refill()) {
+                    break;
+                }
+            }
+            return !text.empty();
+        }
+
+    private:
+        auto init() -> void {
+            struct stat status{};
+            const off_t offset = ::lseek(__fd, 0, SEEK_CUR);
+            if (::fstat(__fd, &status) == 0 && S_ISREG(status.st_mode) && offset >= 0 && status.st_size > offset) {
+                const auto bytes = static_cast<size_t>(status.st_size);
+                void* mapped = ::mmap(nullptr, bytes, PROT_READ, MAP_PRIVATE, __fd, 0);
+                if (mapped != MAP_FAILED) {
+                    ::madvise(mapped, bytes, MADV_SEQUENTIAL);
+                    __mapping = mapped;
+                    __mapping_bytes = bytes;
+                    __begin = static_cast<const char*>(mapped) + offset;
+                    __end = static_cast<const char*>(mapped) + bytes;
+                    __is_ended = true;
+                    return;
+                }
+            }
+            // Не получилось отобразить - читаем как поток
+            __buffer.resize(kBufferBytes);
+            __begin = __buffer.data();
+            __end = __buffer.data();
+        }
+
+        // Переносит непрочитанный хвост в начало буфера и дочитывает после него. Возвращает false,
+        // если ввод закончился.
+        auto refill() -> bool {
+            if (__is_ended) {
+                return false;
+            }
+            const auto unread = static_cast<size_t>(__end - __begin);
+            std::memmove(__buffer.data(), __begin, unread);
+            if (unread == __buffer.size()) {
+                __buffer.resize(__buffer.size() * 2);
+            }
+
+            ssize_t got = 0;
+            do {
+                got = ::read(__fd, __buffer.data() + unread, __buffer.size() - unread);
+            } while (got < 0 && errno == EINTR);
+            if (got < 0) {
+                throw std::system_error(errno, std::generic_category(), "failed to read input");
+            }
+            __is_ended = got == 0;
+            __begin = __buffer.data();
+            __end = __buffer.data() + unread + got;
+            return got != 0;
+        }
+
+        const int __fd;
+        const bool __is_owning = false;
+        void* __mapping = nullptr;
+        size_t __mapping_bytes = 0;
+        std::vector<char> __buffer;
+        const char* __begin = nullptr;
+        const char* __end = nullptr;
+        bool __is_ended = false;
+    };
+
+    // Общий на всю программу читатель stdin. Через std::cin после него читать нельзя: он забирает
+    // ввод блоками наперед.
+    inline auto getStdin() -> InputReader& {
+        static InputReader reader(STDIN_FILENO);
+        return reader;
+    }
+
+    template <typename T>
+    concept ReservableEmplacableContainer = requires (T c) {
+        typename T::value_type;
+        c.reserve(size_t{0});
+        c.emplace_back();
+    };
+
+    template <std::integral Value>
+    auto getFromInput(InputReader& input) -> Value {
+        Value var;
+        if (!input.read(var)) {
+            throw std::runtime_error("Failed to read value from stream");
+        }
+        return var;
+    }
+
+    template <std::integral Value>
+    auto getFromStdin() -> Value {
+        Value var;
+        if (!getStdin().read(var)) {
+            throw std::runtime_error("Failed to read value from stdin");
+        }
+        return var;
+    }
+
+    template <ReservableEmplacableContainer Collection, typename ... Args>
+    auto getFromStdin(const size_t n, Args ... ns) -> Collection {
+        Collection collection;
+        collection.reserve(n);
+        for (size_t i = 0; i < n; ++i) {
+            collection.emplace_back(
+                getFromStdin<typename Collection::value_type>(ns...));
+        }
+        return collection;
+    }
+
+    // Заполняет values числами из stdin подряд
+    template <std::integral Value>
+    auto getFromStdin(const std::span<Value> values) -> void {
+        auto& input = getStdin();
+        for (auto& value : values) {
+            if (!input.read(value)) {
+                throw std::runtime_error("Failed to read value from stdin");
+            }
+        }
+    }
+
+    // Разбирает кусок текста (см. InputReader::readText) в числа так же, как их читает
+    // InputReader::read, но не больше max_count. Возвращает false, если разбор остановился на чем-то,
+    // что не является числом: ошибка ли это, решает вызывающий, так как после последнего нужного
+    // числа во входе может быть что угодно.
+    template <std::integral Number>
+    auto parseNumbers(const std::string_view text, std::vector<Number>& numbers, const size_t max_count) -> bool {
+        numbers.clear();
+        const char* current = text.data();
+        const char* const end = text.data() + text.size();
+        while (numbers.size() < max_count) {
+            while (current != end && isSpace(*current)) {
+                ++current;
+            }
+            if (current == end) {
+                return true;
+            }
+            Number number;
+            const auto [next, error] = std::from_chars(*current == '+' ? current + 1 : current, end, number);
+            if (error != std::errc{}) {
+                return false;
+            }
+            numbers.emplace_back(number);
+            current = next;
+        }
+        return true;
+    }
+}  // namespace common
@@ -0,0 +1,329 @@
+#pragma once
+
+#include <algorithm>
+#include <cerrno>
+#include <concepts>
+#include <cstdint>
+#include <cstdlib>
+#include <limits>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+// Матрица для динамического программирования, общая для всех задач.
+//
+// Как хранить данные и как их раскладывать в памяти задается политиками:
+//   - Storage: VectorStorage (обычная память) или MmapStorage (файл на диске, отображенный в память,
+//     для матриц больше оперативной памяти);
+//   - Layout: RowMajorLayout (строки подряд, доступны как std::span) или TiledLayout (квадратные блоки
+//     подряд, так что верхний и диагональный соседи почти всегда лежат в том же блоке);
+//   - Access: CheckedAccess (каждое обращение проверяет индексы) или UncheckedAccess (для горячих циклов).
+namespace common {
+    template <std::unsigned_integral I>
+    auto safeUMull(const I x, const I y) -> I {
+        const I result = x*y;
+        if (x != 0 && result/x != y) {
+            throw std::overflow_error("overflowed unsigned multiplication");
+        }
+        return result;
+    }
+
+    template <typename Type>
+    class VectorStorage {
+    public:
+        VectorStorage(const size_t size, const Type& default_value)
+            : __data(size, default_value)
+        {
+        }
+
+        auto data() -> Type* {
+            return __data.data();
+        }
+
+        auto data() const -> const Type* {
+            return __data.data();
+        }
+
+    private:
+        std::vector<Type> __data;
+    };
+
+    // Данные лежат во временном файле, который удаляется сразу после создания, так что он
+    // исчезнет вместе с процессом. Страницы подгружает и выгружает ядро, поэтому матрица может
+    // быть больше оперативной памяти. Каталог для файла берется из TMPDIR.
+    template <typename Type>
+        requires std::is_trivially_copyable_v<Type>
+    class MmapStorage {
+    public:
+        MmapStorage(const size_t size, const Type& default_value)
+            : __bytes(safeUMull(size, sizeof(Type)))
+        {
+            if (__bytes == 0) {
+                return;
+            }
+
+            const char* tmp_dir = std::getenv("TMPDIR");
+            std::string path = std::string(tmp_dir != nullptr ? tmp_dir : "/tmp") + "/matrix.XXXXXX";
+            const int fd = ::mkstemp(path.data());
+            if (fd < 0) {
+                throw std::system_error(errno, std::generic_category(), "failed to create matrix file");
+            }
+            ::unlink(path.c_str());
+
+            if (::ftruncate(fd, static_cast<off_t>(__bytes)) != 0) {
+                const int error = errno;
+                ::close(fd);
+                throw std::system_error(error, std::generic_category(), "failed to resize matrix file");
+            }
+            void* mapped = ::mmap(nullptr, __bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+            const int error = errno;
+            ::close(fd);
+            if (mapped == MAP_FAILED) {
+                throw std::system_error(error, std::generic_category(), "failed to map matrix file");
+            }
+            __data = static_cast<Type*>(mapped);
+
+            // Файл после ftruncate уже заполнен нулями
+            if (default_value != Type{}) {
+                std::fill(__data, __data + size, default_value);
+            }
+        }
+
+        MmapStorage(const MmapStorage&) = delete;
+        auto operator=(const MmapStorage&) -> MmapStorage& = delete;
+
+        MmapStorage(MmapStorage&& other) noexcept
+            : __data(std::exchange(other.__data, nullptr))
+            , __bytes(std::exchange(other.__bytes, 0))
+        {
+        }
+
+        auto operator=(MmapStorage&& other) noexcept -> MmapStorage& {
+            if (this != &other) {
+                unmap();
+                __data = std::exchange(other.__data, nullptr);
+                __bytes = std::exchange(other.__bytes, 0);
+            }
+            return *this;
+        }
+
+        ~MmapStorage() {
+            unmap();
+        }
+
+        auto data() -> Type* {
+            return __data;
+        }
+
+        auto data() const -> const Type* {
+            return __data;
+        }
+
+    private:
+        auto unmap() -> void {
+            if (__data != nullptr) {
+                ::munmap(__data, __bytes);
+            }
+        }
+
+        Type* __data = nullptr;
+        size_t __bytes = 0;
+    };
+
+    class RowMajorLayout {
+    public:
+        constexpr static bool kHasContiguousRows = true;
+
+        RowMajorLayout(const size_t height, const size_t width)
+            : __w(width)
+            , __size(safeUMull(height, width))
+        {
+        }
+
+        auto getSize() const -> size_t {
+            return __size;
+        }
+
+        auto getOffset(const size_t i, const size_t j) const -> size_t {
+            return i * __w + j;
+        }
+
+    private:
+        size_t __w;
+        size_t __size;
+    };
+
+    // Блоки kTileSize x kTileSize лежат подряд, внутри блока построчно. Размер блока степень двойки,
+    // так что деления сводятся к сдвигам.
+    template <size_t kTileSize>
+        requires (kTileSize > 0 && (kTileSize & (kTileSize - 1)) == 0)
+    class TiledLayout {
+    public:
+        constexpr static bool kHasContiguousRows = false;
+
+        TiledLayout(const size_t height, const size_t width)
+            : __tiles_per_row((width + kTileSize - 1) / kTileSize)
+            , __size(safeUMull(
+                  safeUMull((height + kTileSize - 1) / kTileSize, __tiles_per_row),
+                  kTileSize * kTileSize))
+        {
+        }
+
+        auto getSize() const -> size_t {
+            return __size;
+        }
+
+        auto getOffset(const size_t i, const size_t j) const -> size_t {
+            const size_t tile = (i / kTileSize) * __tiles_per_row + j / kTileSize;
+            return tile * (kTileSize * kTileSize) + (i % kTileSize) * kTileSize + j % kTileSize;
+        }
+
+    private:
+        size_t __tiles_per_row;
+        size_t __size;
+    };
+
+    struct CheckedAccess {
+        constexpr static bool kIsChecked = true;
+    };
+
+    struct UncheckedAccess {
+        constexpr static bool kIsChecked = false;
+    };
+
+    template <
+        typename Type,
+        typename Layout = RowMajorLayout,
+        typename Storage = VectorStorage<Type>,
+        typename Access = CheckedAccess
+    >
+    class Matrix {
+    public:
+        Matrix(const size_t height, const size_t width, const Type& default_value = Type{})
+            : __layout(height, width)
+            , __storage(__layout.getSize(), default_value)
+            , __h(height)
+            , __w(width)
+        {
+        }
+
+        Matrix() = delete;
+        Matrix(const Matrix&) = delete;
+        auto operator=(const Matrix&) -> Matrix& = delete;
+        Matrix(Matrix&&) = default;
+        auto operator=(Matrix&&) -> Matrix& = default;
+
+    private:
+        auto checkHeightWidth(const size_t h, const size_t w) const -> void {
+            if (h >= getHeight() || w >= getWidth()) {
+                throw std::out_of_range("invalid indecies to access matrix");
+            }
+        }
+
+        auto unchekedAt(const size_t i, const size_t j) -> Type& {
+            return __storage.data()[__layout.getOffset(i, j)];
+        }
+
+        auto unchekedAt(const size_t i, const size_t j) const -> const Type& {
+            return __storage.data()[__layout.getOffset(i, j)];
+        }
+
+    public:
+        auto operator()(const size_t i, const size_t j) -> Type& {
+            if constexpr (Access::kIsChecked) {
+                checkHeightWidth(i, j);
+            }
+            return unchekedAt(i, j);
+        }
+
+        auto operator()(const size_t i, const size_t j) const -> const Type& {
+            if constexpr (Access::kIsChecked) {
+                checkHeightWidth(i, j);
+            }
+            return unchekedAt(i, j);
+        }
+
+        // Строка целиком без проверок на каждый элемент, только для построчной раскладки
+        auto getRow(const size_t i) -> std::span<Type>
+            requires Layout::kHasContiguousRows
+        {
+            if constexpr (Access::kIsChecked) {
+                checkHeightWidth(i, 0);
+            }
+            return std::span<Type>(&unchekedAt(i, 0), getWidth());
+        }
+
+        auto getRow(const size_t i) const -> std::span<const Type>
+            requires Layout::kHasContiguousRows
+        {
+            if constexpr (Access::kIsChecked) {
+                checkHeightWidth(i, 0);
+            }
+            return std::span<const Type>(&unchekedAt(i, 0), getWidth());
+        }
+
+        auto getHeight() const -> size_t {
+            return __h;
+        }
+
+        auto getWidth() const -> size_t {
+            return __w;
+        }
+
+        template <typename Func>
+            requires requires (Func f, Type& val) {
+                { f(0, 0, val) } -> std::same_as<void>;
+            }
+        auto forEach(Func f) {
+            forEachInBlock(0, getHeight(), 0, getWidth(), f);
+        }
+
+        // Обход только прямоугольного блока [i_begin, i_end) x [j_begin, j_end)
+        template <typename Func>
+            requires requires (Func f, Type& val) {
+                { f(0, 0, val) } -> std::same_as<void>;
+            }
+        auto forEachInBlock(
+            const size_t i_begin, const size_t i_end,
+            const size_t j_begin, const size_t j_end,
+            Func f)
+        {
+            if (i_begin >= i_end || j_begin >= j_end) {
+                return;
+            }
+            checkHeightWidth(i_end-1, j_end-1);
+            for (size_t i = i_begin; i < i_end; ++i) {
+                for (size_t j = j_begin; j < j_end; ++j) {
+                    f(i, j, unchekedAt(i, j));
+                }
+            }
+        }
+
+    private:
+        Layout __layout;
+        Storage __storage;
+        size_t __h;
+        size_t __w;
+    };
+
+    // Самый узкий беззнаковый тип клетки, в который влезают значения до max_value. Функтор вызывается
+    // с std::type_identity нужного типа, например для длин НОП, которые не превышают длины входа.
+    template <typename Func>
+    auto dispatchCellType(const std::uint64_t max_value, Func&& func) {
+        if (max_value <= std::numeric_limits<std::uint16_t>::max()) {
+            return func(std::type_identity<std::uint16_t>{});
+        }
+        if (max_value <= std::numeric_limits<std::uint32_t>::max()) {
+            return func(std::type_identity<std::uint32_t>{});
+        }
+        return func(std::type_identity<std::uint64_t>{});
+    }
+}  // namespace common
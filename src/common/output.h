@@ -0,0 +1,148 @@
+#pragma once
+
+#include <bit>
+#include <cerrno>
+#include <charconv>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+#include <system_error>
+#include <vector>
+
+#include <unistd.h>
+
+namespace common {
+    // Вывод без iostream: все пишется в большой буфер, числа переводятся в текст std::to_chars, а
+    // в дескриптор буфер уходит только когда заполнится, по явному flush() и при разрушении. Так
+    // миллионы чисел не платят ни за сброс на каждой строке, ни за локаль.
+    //
+    // В двоичном формате числа пишутся как int64 в little-endian (беззнаковые - теми же 8 байтами),
+    // разделители пропускаются, а слова и символы пишутся как есть. Так вывод можно сразу читать
+    // следующей программой в конвейере, не разбирая текст.
+    class OutputWriter {
+    public:
+        constexpr static size_t kBufferBytes = size_t{1} << 20;
+
+        enum class Format {
+            kText,
+            kBinary,
+        };
+
+        explicit OutputWriter(const int fd)
+            : __fd(fd)
+        {
+            __buffer.reserve(kBufferBytes);
+        }
+
+        OutputWriter(const OutputWriter&) = delete;
+        auto operator=(const OutputWriter&) -> OutputWriter& = delete;
+
+        // Ошибку записи из деструктора уже некому сообщить
+        ~OutputWriter() {
+            try {
+                flush();
+            } catch (...) {
+            }
+        }
+
+        auto setFormat(const Format format) -> void {
+            __format = format;
+        }
+
+        auto getFormat() const -> Format {
+            return __format;
+        }
+
+        template <std::integral Number>
+            requires (!std::same_as<Number, char> && !std::same_as<Number, bool>)
+        auto writeNumber(const Number number) -> OutputWriter& {
+            if (__format == Format::kBinary) {
+                auto value = static_cast<std::uint64_t>(number);
+                if constexpr (std::endian::native == std::endian::big) {
+                    value = __builtin_bswap64(value);
+                }
+                char bytes[sizeof(value)];
+                std::memcpy(bytes, &value, sizeof(value));
+                return writeText(std::string_view(bytes, sizeof(bytes)));
+            }
+
+            // Самое длинное 64-битное число со знаком занимает 20 символов
+            char text[24];
+            const auto [end, error] = std::to_chars(text, text + sizeof(text), number);
+            return writeText(std::string_view(text, end - text));
+        }
+
+        // Как и потоки по умолчанию, в тексте оставляет 6 значащих цифр. В двоичном формате число
+        // пишется 8 байтами double в little-endian.
+        template <std::floating_point Number>
+        auto writeNumber(const Number number) -> OutputWriter& {
+            if (__format == Format::kBinary) {
+                return writeNumber(std::bit_cast<std::uint64_t>(static_cast<double>(number)));
+            }
+
+            char text[32];
+            const auto [end, error] = std::to_chars(text, text + sizeof(text), number, std::chars_format::general, 6);
+            return writeText(std::string_view(text, end - text));
+        }
+
+        auto writeText(const std::string_view text) -> OutputWriter& {
+            if (__buffer.size() + text.size() > kBufferBytes) {
+                flush();
+            }
+            if (text.size() > kBufferBytes) {
+                writeToFd(text);
+            } else {
+                __buffer.insert(__buffer.end(), text.begin(), text.end());
+            }
+            return *this;
+        }
+
+        auto writeChar(const char c) -> OutputWriter& {
+            if (__buffer.size() == kBufferBytes) {
+                flush();
+            }
+            __buffer.push_back(c);
+            return *this;
+        }
+
+        // Пробел или перевод строки между значениями; в двоичном формате не пишется
+        auto writeSeparator(const char separator) -> OutputWriter& {
+            if (__format == Format::kText) {
+                writeChar(separator);
+            }
+            return *this;
+        }
+
+        auto flush() -> void {
+            writeToFd(std::string_view(__buffer.data(), __buffer.size()));
+            __buffer.clear();
+        }
+
+    private:
+        auto writeToFd(std::string_view text) -> void {
+            while (!text.empty()) {
+                const ssize_t written = ::write(__fd, text.data(), text.size());
+                if (written < 0) {
+                    if (errno == EINTR) {
+                        continue;
+                    }
+                    throw std::system_error(errno, std::generic_category(), "failed to write output");
+                }
+                text.remove_prefix(static_cast<size_t>(written));
+            }
+        }
+
+        const int __fd;
+        Format __format = Format::kText;
+        std::vector<char> __buffer;
+    };
+
+    // Общий на всю программу писатель stdout, сбрасывается при выходе из программы. Через
+    // std::cout в stdout вперемешку с ним писать нельзя: у них разные буферы.
+    inline auto getStdout() -> OutputWriter& {
+        static OutputWriter writer(STDOUT_FILENO);
+        return writer;
+    }
+}  // namespace common
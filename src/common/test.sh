@@ -0,0 +1,61 @@
+# Общие проверки для test.sh инструментов, подключаются через source. Перед подключением
+# в переменной bin должен лежать путь к проверяемой программе.
+
+failures=0
+
+# check ИМЯ ВВОД ОЖИДАЕМЫЙ_ВЫВОД [АРГУМЕНТЫ...]
+#
+# Запускает программу с аргументами на заданном вводе и сравнивает stdout с ожидаемым
+# (переводы строк в конце не учитываются). Программа должна завершиться успешно.
+check() {
+    local name=$1 input=$2 expected=$3
+    shift 3
+    local actual status=0
+    actual=$(printf '%s' "$input" | "$bin" "$@" 2>/dev/null) || status=$?
+    if [[ $status -ne 0 || "$actual" != "$expected" ]]; then
+        echo "FAIL $name (exit $status)"
+        echo "  expected: $(printf '%q' "$expected")"
+        echo "  actual:   $(printf '%q' "$actual")"
+        failures=$((failures + 1))
+    fi
+}
+
+# checkError ИМЯ ВВОД ОЖИДАЕМАЯ_ОШИБКА [АРГУМЕНТЫ...]
+#
+# Программа должна завершиться с ненулевым кодом, а в stderr должна быть подстрока
+# ОЖИДАЕМАЯ_ОШИБКА.
+checkError() {
+    local name=$1 input=$2 expected=$3
+    shift 3
+    local errors status=0
+    errors=$(printf '%s' "$input" | "$bin" "$@" 2>&1 >/dev/null) || status=$?
+    if [[ $status -eq 0 || "$errors" != *"$expected"* ]]; then
+        echo "FAIL $name (exit $status)"
+        echo "  expected error: $expected"
+        echo "  actual stderr:  $errors"
+        failures=$((failures + 1))
+    fi
+}
+
+# checkLog ИМЯ ВВОД ОЖИДАЕМЫЙ_ТЕКСТ [АРГУМЕНТЫ...]
+#
+# Программа должна завершиться успешно, а в stderr должна быть подстрока ОЖИДАЕМЫЙ_ТЕКСТ.
+checkLog() {
+    local name=$1 input=$2 expected=$3
+    shift 3
+    local errors status=0
+    errors=$(printf '%s' "$input" | "$bin" "$@" 2>&1 >/dev/null) || status=$?
+    if [[ $status -ne 0 || "$errors" != *"$expected"* ]]; then
+        echo "FAIL $name (exit $status)"
+        echo "  expected stderr: $expected"
+        echo "  actual stderr:   $errors"
+        failures=$((failures + 1))
+    fi
+}
+
+finish() {
+    if [[ $failures -ne 0 ]]; then
+        echo "$failures check(s) failed"
+        exit 1
+    fi
+}
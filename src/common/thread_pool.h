@@ -0,0 +1,121 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace common {
+    // Простой пул потоков для параллельных циклов: run(tasks_count, func) раздает номера задач
+    // [0, tasks_count) рабочим потокам и возвращается, когда все они выполнены. Вызывающий поток
+    // тоже берет задачи, так что пул на N потоков держит N-1 рабочих.
+    //
+    // Если задача бросила исключение, оставшиеся задачи не запускаются, а первое исключение
+    // перебрасывается из run() в вызывающем потоке.
+    class ThreadPool {
+    public:
+        explicit ThreadPool(const size_t threads_count) {
+            for (size_t i = 1; i < threads_count; ++i) {
+                __workers.emplace_back([this]() { workerLoop(); });
+            }
+        }
+
+        ~ThreadPool() {
+            {
+                std::lock_guard lock(__mutex);
+                __is_stopped = true;
+            }
+            __wake_up.notify_all();
+            for (auto& worker : __workers) {
+                worker.join();
+            }
+        }
+
+        ThreadPool(const ThreadPool&) = delete;
+        ThreadPool(ThreadPool&&) = delete;
+
+        auto getThreadsCount() const -> size_t {
+            return __workers.size() + 1;
+        }
+
+        template <typename Func>
+        auto run(const size_t tasks_count, Func&& func) -> void {
+            if (__workers.empty() || tasks_count <= 1) {
+                for (size_t i = 0; i < tasks_count; ++i) {
+                    func(i);
+                }
+                return;
+            }
+            {
+                std::lock_guard lock(__mutex);
+                __task = [&func](const size_t i) { func(i); };
+                __tasks_count = tasks_count;
+                __next_task = 0;
+                __error = nullptr;
+                __busy_workers = __workers.size();
+                __generation += 1;
+            }
+            __wake_up.notify_all();
+            work();
+
+            std::unique_lock lock(__mutex);
+            __all_done.wait(lock, [this]() { return __busy_workers == 0; });
+            if (__error != nullptr) {
+                std::rethrow_exception(std::exchange(__error, nullptr));
+            }
+        }
+
+    private:
+        auto work() -> void {
+            for (size_t i = __next_task++; i < __tasks_count; i = __next_task++) {
+                try {
+                    __task(i);
+                } catch (...) {
+                    std::lock_guard lock(__mutex);
+                    if (__error == nullptr) {
+                        __error = std::current_exception();
+                    }
+                    __next_task = __tasks_count;
+                }
+            }
+        }
+
+        auto workerLoop() -> void {
+            size_t seen_generation = 0;
+            for (;;) {
+                {
+                    std::unique_lock lock(__mutex);
+                    __wake_up.wait(lock, [&]() { return __is_stopped || __generation != seen_generation; });
+                    if (__is_stopped) {
+                        return;
+                    }
+                    seen_generation = __generation;
+                }
+                work();
+                {
+                    std::lock_guard lock(__mutex);
+                    if (--__busy_workers == 0) {
+                        __all_done.notify_one();
+                    }
+                }
+            }
+        }
+
+        std::vector<std::thread> __workers;
+        std::mutex __mutex;
+        std::condition_variable __wake_up;
+        std::condition_variable __all_done;
+        std::function<void(size_t)> __task;
+        size_t __tasks_count = 0;
+        std::atomic<size_t> __next_task = 0;
+        std::exception_ptr __error;
+        size_t __busy_workers = 0;
+        size_t __generation = 0;
+        bool __is_stopped = false;
+    };
+}  // namespace common
@@ -1,87 +1,752 @@
 #include <algorithm>
+#include <atomic>
+#include <bit>
+#include <charconv>
+#include <chrono>
+#include <cmath>
+#include <concepts>
 #include <cstdint>
 #include <iostream>
+#include <limits>
+#include <numeric>
+#include <optional>
+#include <random>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <tuple>
 #include <vector>
-#include <set>
-#include <stack>
 #include <iterator>
 
-namespace common {
-    template <typename Value>
-    auto getFromStdin() -> Value {
-        Value var;
-        std::cin >> var;
-        if (!std::cin.good()) {
-            throw std::runtime_error("Failed to read value from stdin");
-        }
-        return var;
-    }
-}  // namespace common
+#include "common/csr_graph.h"
+#include "common/input.h"
+#include "common/output.h"
+#include "common/thread_pool.h"
 
 namespace solution {
     using NodeID = std::uint64_t;
     using Edge = std::tuple<NodeID, NodeID>;
 
-    auto solve(const std::size_t nodes_count, const std::vector<Edge>& edges) -> std::vector<std::set<NodeID>> {
-        std::vector<std::vector<NodeID>> nodes_connections(nodes_count+1);
-        std::vector<bool> nodes_visited(nodes_count+1, false);
- 
-        for (const auto& [edge_one, edge_two] : edges) {
-            nodes_connections[edge_one].emplace_back(edge_two);
-            nodes_connections[edge_two].emplace_back(edge_one);
+    // Вершины и ребра хранятся в самом узком типе, в который влезают номера вершин и ссылки CSR.
+    // Вершины нумеруются с единицы, так что в графе на одну (нулевую, неиспользуемую) вершину больше.
+    template <std::unsigned_integral Node>
+    using BasicEdge = std::tuple<Node, Node>;
+
+    template <std::unsigned_integral Node>
+    auto checkEdge(const Node one, const Node two, const size_t nodes_count) -> void {
+        if (one == 0 || two == 0 || one > nodes_count || two > nodes_count) {
+            throw std::out_of_range("edge node id is out of range");
         }
+    }
 
-        std::vector<std::set<NodeID>> connectivity_components;
-        for (size_t node_id = 1; node_id < nodes_count+1; ++node_id) {
-            std::set<NodeID> connectivity_component;
-            std::stack<NodeID> nodes_to_traverse;
-            nodes_to_traverse.emplace(node_id);
+    // Все компоненты в одном массиве: вершины k-й компоненты лежат в __nodes[__offsets[k], __offsets[k+1])
+    // по возрастанию, а сами компоненты упорядочены по наименьшей вершине.
+    template <std::unsigned_integral Node>
+    class Components {
+    public:
+        // labels[v] - любой идентификатор компоненты вершины v не больше количества вершин, одинаковый
+        // у всех вершин компоненты. Группировка сортировкой подсчетом по номерам компонент.
+        explicit Components(const std::vector<Node>& labels) {
+            constexpr Node kNoIndex = std::numeric_limits<Node>::max();
+            std::vector<Node> indices(labels.size(), kNoIndex);
+            __offsets.emplace_back(0);
+            for (size_t node = 1; node < labels.size(); ++node) {
+                auto& index = indices[labels[node]];
+                if (index == kNoIndex) {
+                    index = __offsets.size() - 1;
+                    __offsets.emplace_back(0);
+                }
+                __offsets[index + 1] += 1;
+            }
+            std::inclusive_scan(__offsets.begin(), __offsets.end(), __offsets.begin());
 
-            while (!nodes_to_traverse.empty()) {
-                auto current_node = nodes_to_traverse.top();
-                nodes_to_traverse.pop();
+            __nodes.resize(__offsets.back());
+            std::vector<Node> positions(__offsets.begin(), __offsets.end() - 1);
+            for (size_t node = 1; node < labels.size(); ++node) {
+                __nodes[positions[indices[labels[node]]]++] = node;
+            }
+        }
 
-                if (!nodes_visited[current_node]) {
-                    for (auto next_node : nodes_connections[current_node]) {
-                        nodes_to_traverse.emplace(next_node);
+        auto size() const -> size_t {
+            return __offsets.size() - 1;
+        }
+
+        auto operator[](const size_t k) const -> std::span<const Node> {
+            return std::span<const Node>(__nodes).subspan(__offsets[k], __offsets[k + 1] - __offsets[k]);
+        }
+
+    private:
+        std::vector<Node> __offsets;
+        std::vector<Node> __nodes;
+    };
+
+    // Обход в глубину с явным стеком. Вершина помечается при добавлении в стек, так что каждая
+    // попадает в него один раз. Меткой служит наименьшая вершина компоненты.
+    template <std::unsigned_integral Node>
+    auto labelComponents(const common::CsrGraph<Node>& graph) -> std::vector<Node> {
+        constexpr Node kUnlabeled = 0;
+        const size_t nodes_count = graph.getNodesCount() - 1;
+        std::vector<Node> labels(nodes_count + 1, kUnlabeled);
+        std::vector<Node> nodes_to_traverse;
+
+        for (size_t root = 1; root <= nodes_count; ++root) {
+            if (labels[root] != kUnlabeled) {
+                continue;
+            }
+            labels[root] = root;
+            nodes_to_traverse.emplace_back(root);
+            while (!nodes_to_traverse.empty()) {
+                const Node current_node = nodes_to_traverse.back();
+                nodes_to_traverse.pop_back();
+                for (const Node next_node : graph.getNeighbours(current_node)) {
+                    if (labels[next_node] == kUnlabeled) {
+                        labels[next_node] = root;
+                        nodes_to_traverse.emplace_back(next_node);
                     }
-                    connectivity_component.emplace(current_node);
-                    nodes_visited[current_node] = true;
                 }
             }
+        }
+        return labels;
+    }
+
+    constexpr size_t kParallelChunkNodes = size_t{1} << 14;
+
+    template <typename Func>
+    auto parallelFor(common::ThreadPool& pool, const size_t begin, const size_t end, Func&& func) -> void {
+        const size_t chunks_count = (end - begin + kParallelChunkNodes - 1) / kParallelChunkNodes;
+        pool.run(chunks_count, [&](const size_t chunk) {
+            const size_t chunk_begin = begin + chunk * kParallelChunkNodes;
+            const size_t chunk_end = std::min(chunk_begin + kParallelChunkNodes, end);
+            for (size_t i = chunk_begin; i < chunk_end; ++i) {
+                func(i);
+            }
+        });
+    }
+
+    // Параллельная разметка компонент по схеме Afforest (Sutton, Ben-Nun, Barak, 2018).
+    //
+    // Сначала каждая вершина связывается только с первыми kAfforestNeighbourRounds соседями, и после
+    // этого почти вся большая компонента уже собрана в одно дерево. По случайной выборке вершин
+    // находим самую частую компоненту и ее вершины дальше пропускаем: граф неориентированный, так что
+    // ребро между ней и другой вершиной обработается со стороны другой вершины. Остальные вершины
+    // связываются со всеми оставшимися соседями.
+    //
+    // Связывание подвешивает больший корень к меньшему через CAS, так что корнем остается наименьшая
+    // вершина. Между фазами деревья сжимаются прыжками по указателям до корня.
+    constexpr size_t kAfforestNeighbourRounds = 2;
+    constexpr size_t kAfforestSamples = 1024;
+
+    template <std::unsigned_integral Node>
+    auto labelComponentsInParallel(const common::CsrGraph<Node>& graph, common::ThreadPool& pool) -> std::vector<Node> {
+        constexpr auto kRelaxed = std::memory_order_relaxed;
+        const size_t nodes_count = graph.getNodesCount() - 1;
+        std::vector<std::atomic<Node>> parents(nodes_count + 1);
+        parallelFor(pool, 0, parents.size(), [&](const size_t node) {
+            parents[node].store(node, kRelaxed);
+        });
+
+        const auto link = [&](const Node one, const Node two) {
+            Node first = parents[one].load(kRelaxed);
+            Node second = parents[two].load(kRelaxed);
+            while (first != second) {
+                const Node high = std::max(first, second);
+                const Node low = std::min(first, second);
+                Node high_parent = parents[high].load(kRelaxed);
+                if (high_parent == low) {
+                    return;
+                }
+                if (high_parent == high && parents[high].compare_exchange_strong(high_parent, low, std::memory_order_acq_rel)) {
+                    return;
+                }
+                first = parents[parents[high].load(kRelaxed)].load(kRelaxed);
+                second = parents[low].load(kRelaxed);
+            }
+        };
+        const auto compress = [&]() {
+            parallelFor(pool, 1, parents.size(), [&](const size_t node) {
+                Node parent = parents[node].load(kRelaxed);
+                for (Node grandparent = parents[parent].load(kRelaxed); parent != grandparent;
+                        grandparent = parents[parent].load(kRelaxed)) {
+                    parent = grandparent;
+                }
+                parents[node].store(parent, kRelaxed);
+            });
+        };
+
+        for (size_t round = 0; round < kAfforestNeighbourRounds; ++round) {
+            parallelFor(pool, 1, parents.size(), [&](const size_t node) {
+                if (const auto neighbours = graph.getNeighbours(node); round < neighbours.size()) {
+                    link(node, neighbours[round]);
+                }
+            });
+            compress();
+        }
+
+        Node largest = 0;
+        if (nodes_count != 0) {
+            std::mt19937_64 random(42);
+            std::uniform_int_distribution<size_t> nodes(1, nodes_count);
+            std::vector<Node> samples(kAfforestSamples);
+            for (auto& sample : samples) {
+                sample = parents[nodes(random)].load(kRelaxed);
+            }
+            std::sort(samples.begin(), samples.end());
+            size_t largest_count = 0;
+            for (auto it = samples.begin(); it != samples.end();) {
+                const auto next = std::upper_bound(it, samples.end(), *it);
+                if (static_cast<size_t>(next - it) > largest_count) {
+                    largest_count = next - it;
+                    largest = *it;
+                }
+                it = next;
+            }
+        }
+
+        parallelFor(pool, 1, parents.size(), [&](const size_t node) {
+            if (parents[node].load(kRelaxed) == largest) {
+                return;
+            }
+            const auto neighbours = graph.getNeighbours(node);
+            for (size_t i = kAfforestNeighbourRounds; i < neighbours.size(); ++i) {
+                link(node, neighbours[i]);
+            }
+        });
+        compress();
+
+        std::vector<Node> labels(parents.size());
+        parallelFor(pool, 0, parents.size(), [&](const size_t node) {
+            labels[node] = parents[node].load(kRelaxed);
+        });
+        return labels;
+    }
+
+    // Система непересекающихся множеств с объединением по размеру и сжатием путей делением пополам.
+    // Памяти нужно O(вершин), так что ребра можно объединять прямо по мере чтения, не храня их.
+    template <std::unsigned_integral Node>
+    class DisjointSets {
+    public:
+        explicit DisjointSets(const size_t nodes_count)
+            : __parents(nodes_count + 1)
+            , __sizes(nodes_count + 1, 1)
+        {
+            std::iota(__parents.begin(), __parents.end(), Node{0});
+        }
+
+        auto find(Node node) -> Node {
+            while (__parents[node] != node) {
+                __parents[node] = __parents[__parents[node]];
+                node = __parents[node];
+            }
+            return node;
+        }
+
+        // Возвращает false, если вершины уже были в одном множестве
+        auto unite(const Node one, const Node two) -> bool {
+            Node big = find(one);
+            Node small = find(two);
+            if (big == small) {
+                return false;
+            }
+            if (__sizes[big] < __sizes[small]) {
+                std::swap(big, small);
+            }
+            __parents[small] = big;
+            __sizes[big] += __sizes[small];
+            return true;
+        }
+
+        auto getSize(const Node node) -> Node {
+            return __sizes[find(node)];
+        }
+
+        // Добавляет вершины до nodes_count включительно, каждую отдельным множеством
+        auto grow(const size_t nodes_count) -> void {
+            const size_t old_size = __parents.size();
+            if (nodes_count < old_size) {
+                return;
+            }
+            __parents.resize(nodes_count + 1);
+            std::iota(__parents.begin() + old_size, __parents.end(), old_size);
+            __sizes.resize(nodes_count + 1, 1);
+        }
+
+        auto getNodesCount() const -> size_t {
+            return __parents.size() - 1;
+        }
+
+        // Метка вершины - корень ее множества
+        auto getLabels() -> std::vector<Node> {
+            std::vector<Node> labels(__parents.size());
+            for (size_t node = 0; node < labels.size(); ++node) {
+                labels[node] = find(node);
+            }
+            return labels;
+        }
+
+    private:
+        std::vector<Node> __parents;
+        std::vector<Node> __sizes;
+    };
+
+    // Система непересекающихся множеств без блокировок для нескольких потоков. Корень подвешивается
+    // к другому корню через CAS, причем всегда больший номер к меньшему, так что циклы невозможны.
+    // Сжатие путей тоже через CAS, а неудачная попытка просто пропускается: она лишь не укоротила путь.
+    template <std::unsigned_integral Node>
+    class ConcurrentDisjointSets {
+    public:
+        explicit ConcurrentDisjointSets(const size_t nodes_count)
+            : __parents(nodes_count + 1)
+        {
+            for (size_t node = 0; node < __parents.size(); ++node) {
+                __parents[node].store(node, std::memory_order_relaxed);
+            }
+        }
+
+        auto find(Node node) -> Node {
+            for (;;) {
+                Node parent = __parents[node].load(std::memory_order_acquire);
+                if (parent == node) {
+                    return node;
+                }
+                const Node grandparent = __parents[parent].load(std::memory_order_acquire);
+                if (parent != grandparent) {
+                    __parents[node].compare_exchange_weak(
+                        parent, grandparent, std::memory_order_release, std::memory_order_relaxed);
+                }
+                node = grandparent;
+            }
+        }
+
+        auto unite(Node one, Node two) -> void {
+            for (;;) {
+                one = find(one);
+                two = find(two);
+                if (one == two) {
+                    return;
+                }
+                if (one < two) {
+                    std::swap(one, two);
+                }
+                // Пока мы искали, корень мог успеть подвеситься в другом потоке, тогда повторяем
+                Node expected = one;
+                if (__parents[one].compare_exchange_strong(expected, two, std::memory_order_acq_rel)) {
+                    return;
+                }
+            }
+        }
 
-            if (!connectivity_component.empty()) {
-                connectivity_components.emplace_back(std::move(connectivity_component));
+        // Только после того, как все потоки закончили объединения
+        auto getLabels() -> std::vector<Node> {
+            std::vector<Node> labels(__parents.size());
+            for (size_t node = 0; node < labels.size(); ++node) {
+                labels[node] = find(node);
             }
+            return labels;
         }
 
-        return connectivity_components;
+    private:
+        std::vector<std::atomic<Node>> __parents;
+    };
+
+    enum class Engine {
+        kDfs,
+        kUnionFind,
+        kParallelUnionFind,
+        kAfforest,
+    };
+
+    // С пулом потоков компоненты размечаются параллельно (Afforest), без него обходом в глубину
+    template <std::unsigned_integral Node>
+    auto solve(
+        const std::size_t nodes_count,
+        const std::vector<BasicEdge<Node>>& edges,
+        common::ThreadPool* pool = nullptr) -> Components<Node>
+    {
+        for (const auto& [one, two] : edges) {
+            checkEdge(one, two, nodes_count);
+        }
+        const common::CsrGraph<Node> graph(nodes_count + 1, edges);
+        if (pool != nullptr) {
+            return Components<Node>(labelComponentsInParallel(graph, *pool));
+        }
+        return Components<Node>(labelComponents(graph));
     }
 }  // namespace solution
 
-// https://coderun.yandex.ru/problem/connectivity-components
-auto main() -> int {
-    const auto nodes_count = common::getFromStdin<std::size_t>();
-    const auto edges_count = common::getFromStdin<std::size_t>();
+template <std::unsigned_integral Node>
+auto printComponents(const solution::Components<Node>& connectivity_components) -> void {
+    auto& output = common::getStdout();
+    output.writeNumber(connectivity_components.size()).writeSeparator('\n');
+    for (size_t k = 0; k < connectivity_components.size(); ++k) {
+        const auto component = connectivity_components[k];
+        output.writeNumber(component.size()).writeSeparator('\n');
+        for (const Node node : component) {
+            output.writeNumber(node).writeSeparator(' ');
+        }
+        output.writeSeparator('\n');
+    }
+}
 
-    std::vector<solution::Edge> edges;
+template <std::unsigned_integral Node>
+auto runWithGraph(const size_t nodes_count, const size_t edges_count, common::ThreadPool* pool) -> void {
+    std::vector<solution::BasicEdge<Node>> edges;
     edges.reserve(edges_count);
 
     for (size_t edge = 0; edge < edges_count; ++edge) {
-        edges.emplace_back(
-            std::make_tuple(
-                common::getFromStdin<solution::NodeID>(),
-                common::getFromStdin<solution::NodeID>()));
-    }
-
-    const auto connectivity_components = solution::solve(nodes_count, edges);
-    std::cout << connectivity_components.size() << std::endl;
-    for (const auto& component: connectivity_components) {
-        std::cout << component.size() << std::endl;
-        std::copy(
-            component.begin(),
-            component.end(),
-            std::ostream_iterator<std::int64_t>(std::cout, " "));
-        std::cout << std::endl;
+        const auto one = common::getFromStdin<Node>();
+        const auto two = common::getFromStdin<Node>();
+        edges.emplace_back(one, two);
+    }
+
+    printComponents(solution::solve(nodes_count, edges, pool));
+}
+
+// Ребра объединяются сразу по мере чтения и нигде не хранятся
+template <std::unsigned_integral Node>
+auto runUnionFind(const size_t nodes_count, const size_t edges_count) -> void {
+    solution::DisjointSets<Node> sets(nodes_count);
+    for (size_t edge = 0; edge < edges_count; ++edge) {
+        const auto one = common::getFromStdin<Node>();
+        const auto two = common::getFromStdin<Node>();
+        solution::checkEdge(one, two, nodes_count);
+        sets.unite(one, two);
+    }
+    printComponents(solution::Components<Node>(sets.getLabels()));
+}
+
+constexpr size_t kTextBlockBytes = size_t{4} << 20;
+
+// Вход читается раундами по блоку текста на поток. Блоки раунда разбираются в числа параллельно,
+// затем последовательно определяется, с какого числа в каждом блоке начинаются пары: блок может
+// закончиться посередине ребра, тогда его последнее число склеивается с первым числом следующего.
+// После этого пары каждого блока объединяются параллельно в общей системе множеств.
+template <std::unsigned_integral Node>
+auto runParallelUnionFind(const size_t nodes_count, const size_t edges_count, common::ThreadPool& pool) -> void {
+    if (edges_count > std::numeric_limits<size_t>::max() / 2) {
+        throw std::overflow_error("too many edges");
+    }
+    solution::ConcurrentDisjointSets<Node> sets(nodes_count);
+    auto& input = common::getStdin();
+
+    const size_t blocks_per_round = pool.getThreadsCount();
+    std::vector<std::string> texts(blocks_per_round);
+    std::vector<std::vector<Node>> numbers(blocks_per_round);
+    // Разобран ли блок до конца; не vector<bool>, так как пишется из разных потоков
+    std::vector<std::uint8_t> is_parsed(blocks_per_round);
+    std::vector<size_t> first_pair_starts(blocks_per_round);
+    bool has_pending_node = false;
+    Node pending_node = 0;
+    size_t numbers_left = edges_count * 2;
+
+    while (numbers_left != 0) {
+        size_t blocks_count = 0;
+        while (blocks_count < blocks_per_round && input.readText(texts[blocks_count], kTextBlockBytes)) {
+            ++blocks_count;
+        }
+        if (blocks_count == 0) {
+            throw std::runtime_error("Failed to read value from stdin");
+        }
+        // Больше numbers_left чисел ни одному блоку не нужно, а что лежит после них - не важно
+        pool.run(blocks_count, [&](const size_t k) {
+            is_parsed[k] = common::parseNumbers(texts[k], numbers[k], numbers_left);
+        });
+
+        for (size_t k = 0; k < blocks_count; ++k) {
+            auto& block = numbers[k];
+            if (!is_parsed[k] && block.size() < numbers_left) {
+                throw std::runtime_error("Failed to read value from stdin");
+            }
+            if (block.size() > numbers_left) {
+                block.resize(numbers_left);
+            }
+            numbers_left -= block.size();
+            first_pair_starts[k] = 0;
+            if (has_pending_node && !block.empty()) {
+                solution::checkEdge(pending_node, block.front(), nodes_count);
+                sets.unite(pending_node, block.front());
+                has_pending_node = false;
+                first_pair_starts[k] = 1;
+            }
+            if ((block.size() - first_pair_starts[k]) % 2 != 0) {
+                has_pending_node = true;
+                pending_node = block.back();
+                block.pop_back();
+            }
+        }
+
+        pool.run(blocks_count, [&](const size_t k) {
+            const auto& block = numbers[k];
+            for (size_t i = first_pair_starts[k]; i < block.size(); i += 2) {
+                solution::checkEdge(block[i], block[i+1], nodes_count);
+                sets.unite(block[i], block[i+1]);
+            }
+        });
+    }
+    printComponents(solution::Components<Node>(sets.getLabels()));
+}
+
+template <std::unsigned_integral Node>
+auto run(
+    const size_t nodes_count,
+    const size_t edges_count,
+    const solution::Engine engine,
+    const size_t threads_count) -> void
+{
+    switch (engine) {
+        case solution::Engine::kDfs:
+            runWithGraph<Node>(nodes_count, edges_count, nullptr);
+            return;
+        case solution::Engine::kUnionFind:
+            runUnionFind<Node>(nodes_count, edges_count);
+            return;
+        case solution::Engine::kParallelUnionFind: {
+            common::ThreadPool pool(threads_count);
+            runParallelUnionFind<Node>(nodes_count, edges_count, pool);
+            return;
+        }
+        case solution::Engine::kAfforest: {
+            common::ThreadPool pool(threads_count);
+            runWithGraph<Node>(nodes_count, edges_count, &pool);
+            return;
+        }
+    }
+}
+
+// R-MAT граф со степенным распределением степеней (a = 0.57, b = c = 0.19), 2^scale вершин
+auto makePowerLawEdges(const size_t scale, const size_t edges_count) -> std::vector<solution::BasicEdge<std::uint32_t>> {
+    std::mt19937_64 random(42);
+    std::uniform_real_distribution<double> quadrants(0, 1);
+    std::vector<solution::BasicEdge<std::uint32_t>> edges;
+    edges.reserve(edges_count);
+    for (size_t edge = 0; edge < edges_count; ++edge) {
+        std::uint32_t one = 0;
+        std::uint32_t two = 0;
+        for (size_t bit = 0; bit < scale; ++bit) {
+            const double quadrant = quadrants(random);
+            one = (one << 1) | (quadrant >= 0.76 ? 1 : 0);
+            two = (two << 1) | ((quadrant >= 0.57 && quadrant < 0.76) || quadrant >= 0.95 ? 1 : 0);
+        }
+        edges.emplace_back(one + 1, two + 1);
+    }
+    return edges;
+}
+
+// Квадратная решетка side x side, ребра к правому и нижнему соседу
+auto makeGridEdges(const size_t side) -> std::vector<solution::BasicEdge<std::uint32_t>> {
+    std::vector<solution::BasicEdge<std::uint32_t>> edges;
+    edges.reserve(2 * side * side);
+    for (size_t row = 0; row < side; ++row) {
+        for (size_t column = 0; column < side; ++column) {
+            const std::uint32_t node = row * side + column + 1;
+            if (column + 1 < side) {
+                edges.emplace_back(node, node + 1);
+            }
+            if (row + 1 < side) {
+                edges.emplace_back(node, node + side);
+            }
+        }
+    }
+    return edges;
+}
+
+// Замер масштабирования Afforest от количества потоков относительно обхода в глубину на
+// синтетических графах с 10^6, 10^7, ... ребер, но не больше max_edges_count
+auto runBenchmark(const size_t max_edges_count) -> void {
+    std::vector<size_t> threads_counts;
+    const size_t max_threads = std::max(std::thread::hardware_concurrency(), 1u);
+    for (size_t threads = 1; threads < max_threads; threads *= 2) {
+        threads_counts.emplace_back(threads);
+    }
+    threads_counts.emplace_back(max_threads);
+
+    const auto measure = [](const auto& func) {
+        const auto started = std::chrono::steady_clock::now();
+        func();
+        const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - started;
+        return elapsed.count();
+    };
+
+    // Таблица для человека, поэтому всегда текстом. Каждая строка сбрасывается сразу, что бы
+    // долгий замер было видно по ходу.
+    auto& output = common::getStdout();
+    output.setFormat(common::OutputWriter::Format::kText);
+    const auto bench_graph = [&](const std::string& name, const size_t nodes_count, const auto& edges) {
+        const common::CsrGraph<std::uint32_t> graph(nodes_count + 1, edges);
+        output.writeText(name).writeText(" ").writeNumber(nodes_count).writeText(" nodes ")
+            .writeNumber(edges.size()).writeText(" edges\n");
+        output.writeText("engine\tthreads\tseconds\tspeedup\n");
+        output.flush();
+        const double dfs_seconds = measure([&]() { solution::labelComponents(graph); });
+        output.writeText("dfs\t1\t").writeNumber(dfs_seconds).writeText("\t1\n");
+        output.flush();
+        for (const auto threads : threads_counts) {
+            common::ThreadPool pool(threads);
+            const double seconds = measure([&]() { solution::labelComponentsInParallel(graph, pool); });
+            output.writeText("afforest\t").writeNumber(threads).writeText("\t").writeNumber(seconds)
+                .writeText("\t").writeNumber(dfs_seconds / seconds).writeText("\n");
+            output.flush();
+        }
+    };
+
+    for (size_t edges_count = 1000000; edges_count <= max_edges_count; edges_count *= 10) {
+        // В среднем по 8 ребер на вершину
+        const size_t scale = std::bit_width(edges_count / 8) - 1;
+        bench_graph("power-law", size_t{1} << scale, makePowerLawEdges(scale, edges_count));
+
+        const size_t side = std::sqrt(edges_count / 2);
+        bench_graph("grid", side * side, makeGridEdges(side));
+    }
+}
+
+// Долгоживущий режим для графа, который растет со временем. Ребра сразу объединяются в
+// инкрементальной системе непересекающихся множеств, так что запросы отвечаются за почти константу.
+// Протокол построчный:
+//   add u v   - добавить ребро, ответа нет
+//   conn u v  - YES, если u и v в одной компоненте, иначе NO
+//   size u    - размер компоненты вершины u
+//   dump      - все компоненты в формате обычного режима
+// Вершины появляются при первом упоминании. Ответы копятся в буфере вывода и сбрасываются, только
+// когда уже прочитанный ввод закончился и дальше пришлось бы ждать новых запросов. На неразобранный
+// запрос отвечается строкой "ERROR <причина>", сервер при этом продолжает работу, а граф не меняется.
+// Номера вершин выбирает клиент, поэтому они ограничены max_nodes_count: иначе один запрос с огромным
+// номером заставил бы выделить память под все вершины до него.
+auto runServer(const size_t max_nodes_count) -> void {
+    std::ios::sync_with_stdio(false);
+    std::cin.tie(nullptr);
+    auto& output = common::getStdout();
+
+    solution::DisjointSets<solution::NodeID> sets(0);
+    std::string line;
+    // Вершины добавляются только после разбора всего запроса, что бы ошибочный запрос не менял граф
+    const auto read_node = [&](std::string_view& rest) -> solution::NodeID {
+        const size_t begin = rest.find_first_not_of(" \t\r");
+        const char* const end = rest.data() + rest.size();
+        solution::NodeID node = 0;
+        const auto [next, error] = std::from_chars(rest.data() + std::min(begin, rest.size()), end, node);
+        if (error != std::errc{} || node == 0) {
+            throw std::invalid_argument("Bad node id in request: " + line);
+        }
+        if (node > max_nodes_count) {
+            throw std::invalid_argument(
+                "Node id is above the limit of " + std::to_string(max_nodes_count) + " in request: " + line);
+        }
+        rest.remove_prefix(next - rest.data());
+        return node;
+    };
+    const auto read_edge = [&](std::string_view& rest) -> solution::Edge {
+        const auto one = read_node(rest);
+        const auto two = read_node(rest);
+        sets.grow(std::max(one, two));
+        return solution::Edge(one, two);
+    };
+    const auto answer = [&](const std::string_view command, std::string_view rest) -> void {
+        if (command == "add") {
+            const auto [one, two] = read_edge(rest);
+            sets.unite(one, two);
+        } else if (command == "conn") {
+            const auto [one, two] = read_edge(rest);
+            output.writeText(sets.find(one) == sets.find(two) ? "YES" : "NO").writeSeparator('\n');
+        } else if (command == "size") {
+            const auto node = read_node(rest);
+            sets.grow(node);
+            output.writeNumber(sets.getSize(node)).writeSeparator('\n');
+        } else if (command == "dump") {
+            printComponents(solution::Components<solution::NodeID>(sets.getLabels()));
+        } else {
+            throw std::invalid_argument("Unknown request: " + line);
+        }
+    };
+
+    for (;;) {
+        if (std::cin.rdbuf()->in_avail() <= 0) {
+            output.flush();
+        }
+        if (!std::getline(std::cin, line)) {
+            break;
+        }
+        std::string_view rest = line;
+        const size_t command_begin = std::min(rest.find_first_not_of(" \t\r"), rest.size());
+        const size_t command_end = std::min(rest.find_first_of(" \t\r", command_begin), rest.size());
+        const auto command = rest.substr(command_begin, command_end - command_begin);
+        rest.remove_prefix(command_end);
+
+        if (command.empty()) {
+            continue;
+        }
+        try {
+            answer(command, rest);
+        } catch (const std::invalid_argument& error) {
+            // Ответы до ошибки уже в буфере, а клиенту важно увидеть ошибку сразу
+            output.writeText("ERROR ").writeText(error.what()).writeSeparator('\n');
+            output.flush();
+        }
+    }
+    output.flush();
+}
+
+// https://coderun.yandex.ru/problem/connectivity-components
+//
+// Флаги:
+//   --engine NAME   - dfs (по умолчанию), union-find (ребра не хранятся), parallel-union-find
+//                     или afforest (параллельная разметка по графу в памяти)
+//   --threads N     - количество потоков для parallel-union-find и afforest (по умолчанию все ядра)
+//   --bench MAX     - замер масштабирования afforest на синтетических графах до MAX ребер
+//   --serve         - долгоживущий режим запросов к растущему графу, см. runServer
+//   --max-nodes N   - наибольший номер вершины в запросах --serve (по умолчанию 2^24)
+//   --binary        - числа ответа пишутся как int64 в little-endian, без разделителей
+auto main(int argc, char** argv) -> int {
+    const std::vector<std::string> args(argv + 1, argv + argc);
+    solution::Engine engine = solution::Engine::kDfs;
+    size_t threads_count = std::max(std::thread::hardware_concurrency(), 1u);
+    bool is_serving = false;
+    size_t max_server_nodes_count = size_t{1} << 24;
+    std::optional<size_t> bench_max_edges_count;
+    for (size_t i = 0; i < args.size(); ++i) {
+        if (args[i] == "--threads" && i + 1 < args.size()) {
+            threads_count = std::max<size_t>(std::stoul(args[++i]), 1);
+        } else if (args[i] == "--engine" && i + 1 < args.size()) {
+            const auto& name = args[++i];
+            if (name == "dfs") {
+                engine = solution::Engine::kDfs;
+            } else if (name == "union-find") {
+                engine = solution::Engine::kUnionFind;
+            } else if (name == "parallel-union-find") {
+                engine = solution::Engine::kParallelUnionFind;
+            } else if (name == "afforest") {
+                engine = solution::Engine::kAfforest;
+            } else {
+                throw std::invalid_argument("Unknown engine: " + name);
+            }
+        } else if (args[i] == "--binary") {
+            common::getStdout().setFormat(common::OutputWriter::Format::kBinary);
+        } else if (args[i] == "--serve") {
+            is_serving = true;
+        } else if (args[i] == "--max-nodes" && i + 1 < args.size()) {
+            max_server_nodes_count = std::stoul(args[++i]);
+        } else if (args[i] == "--bench" && i + 1 < args.size()) {
+            bench_max_edges_count = std::stoul(args[++i]);
+        } else {
+            throw std::invalid_argument("Usage: connectivity_components [--engine NAME] [--threads N] [--bench MAX] [--serve [--max-nodes N]] [--binary]");
+        }
+    }
+
+    if (bench_max_edges_count) {
+        runBenchmark(*bench_max_edges_count);
+        return 0;
+    }
+    if (is_serving) {
+        runServer(max_server_nodes_count);
+        return 0;
+    }
+
+    const auto nodes_count = common::getFromStdin<std::size_t>();
+    const auto edges_count = common::getFromStdin<std::size_t>();
+
+    if (common::isCsrNodeTypeEnough<std::uint32_t>(nodes_count + 1, edges_count)) {
+        run<std::uint32_t>(nodes_count, edges_count, engine, threads_count);
+    } else {
+        run<solution::NodeID>(nodes_count, edges_count, engine, threads_count);
     }
 }
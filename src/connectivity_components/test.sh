@@ -0,0 +1,40 @@
+#!/bin/bash
+# Проверки connectivity_components на маленьких входах: test.sh ПУТЬ_К_ПРОГРАММЕ
+set -u
+bin=$1
+source "$(dirname "$0")/../common/test.sh"
+
+graph=$'6 4\n3 1\n1 2\n5 4\n2 3\n'
+components=$'3\n3\n1 2 3 \n2\n4 5 \n1\n6 '
+check "dfs" "$graph" "$components"
+check "union-find" "$graph" "$components" --engine union-find
+check "parallel-union-find" "$graph" "$components" --engine parallel-union-find --threads 2
+check "afforest" "$graph" "$components" --engine afforest --threads 2
+
+# Числа читаются одинаково всеми движками: "+" перед числом допустим, а после последнего ребра
+# во входе может быть что угодно
+for engine in dfs union-find parallel-union-find afforest; do
+    check "plus sign $engine" $'3 2\n+1 2\n2 +3\n' $'1\n3\n1 2 3 ' --engine $engine --threads 2
+    check "tail after edges $engine" $'3 2\n1 2\n2 3\njunk\n' $'1\n3\n1 2 3 ' --engine $engine --threads 2
+    checkError "bad edge $engine" $'3 2\n1 2\njunk 3\n' "Failed to read value" --engine $engine --threads 2
+done
+
+check "serve" $'add 1 2\nconn 1 2\nconn 1 3\nsize 2\n' $'YES\nNO\n2' --serve
+
+# Порядок флагов не важен
+check "serve binary" $'conn 1 1\nconn 1 2\n' "YESNO" --serve --binary
+check "binary serve" $'conn 1 1\nconn 1 2\n' "YESNO" --binary --serve
+
+# Ошибочный запрос получает строку с ошибкой, а следующие запросы отвечаются как обычно
+check "serve bad request" $'add 1 x\nadd 1 2\nconn 1 2\n' \
+    $'ERROR Bad node id in request: add 1 x\nYES' --serve
+check "serve unknown request" $'join 1 2\nsize 1\n' \
+    $'ERROR Unknown request: join 1 2\n1' --serve
+
+# Номер вершины выше --max-nodes отвергается, а не выделяет память под все вершины до него
+check "serve huge node" $'add 1 4000000000\nadd 1 2\nsize 1\n' \
+    $'ERROR Node id is above the limit of 16777216 in request: add 1 4000000000\n2' --serve
+check "serve max nodes" $'add 1 3\nadd 1 4\nsize 1\n' \
+    $'ERROR Node id is above the limit of 3 in request: add 1 4\n2' --serve --max-nodes 3
+
+finish
@@ -1,17 +1,407 @@
 #include <algorithm>
 #include <cstdint>
 #include <iostream>
+#include <iterator>
+#include <limits>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
 #include <vector>
 
+#include "common/input.h"
+#include "common/output.h"
+
 namespace common {
-    template <typename Value>
-    auto getFromStdin() -> Value {
-        Value var;
-        std::cin >> var;
-        if (!std::cin.good()) {
-            throw std::runtime_error("Failed to read value from stdin");
+    // Считает C(n, k) последовательно как C(n-k+i, i) = C(n-k+i-1, i-1) * (n-k+i) / i, на каждом
+    // шаге результат целый. Промежуточные значения только растут, поэтому если какое-то из них
+    // не влезло в uint64, то и ответ не влезет - тогда возвращается пустое значение.
+    inline auto tryBinomial(const std::uint64_t n, std::uint64_t k) -> std::optional<std::uint64_t> {
+        if (k > n) {
+            return 0;
+        }
+        k = std::min(k, n - k);
+
+        std::uint64_t result = 1;
+        for (std::uint64_t i = 1; i <= k; ++i) {
+            const unsigned __int128 next = static_cast<unsigned __int128>(result) * (n - k + i) / i;
+            if (next > std::numeric_limits<std::uint64_t>::max()) {
+                return std::nullopt;
+            }
+            result = static_cast<std::uint64_t>(next);
+        }
+        return result;
+    }
+
+    // То же, но бросает std::overflow_error, если ответ не влезает в uint64
+    inline auto binomial(const std::uint64_t n, const std::uint64_t k) -> std::uint64_t {
+        if (const auto result = tryBinomial(n, k)) {
+            return *result;
+        }
+        throw std::overflow_error("binomial coefficient does not fit into uint64");
+    }
+
+    // Треугольник Паскаля, который достраивается по мере надобности. Строки хранятся подряд одна
+    // за другой. Выше kMaxLevel строки не строятся, так как их центральные элементы уже не влезают
+    // в uint64, а для крайних элементов таких строк хватает и binomial().
+    class PascalTriangle {
+    public:
+        constexpr static std::uint64_t kMaxLevel = 67;
+
+        auto operator()(const std::uint64_t n, const std::uint64_t k) -> std::uint64_t {
+            if (const auto result = tryGet(n, k)) {
+                return *result;
+            }
+            throw std::overflow_error("binomial coefficient does not fit into uint64");
+        }
+
+        // Пустое значение, если C(n, k) не влезает в uint64
+        auto tryGet(const std::uint64_t n, const std::uint64_t k) -> std::optional<std::uint64_t> {
+            if (k > n) {
+                return 0;
+            }
+            if (n > kMaxLevel) {
+                return tryBinomial(n, k);
+            }
+            while (__rows_count <= n) {
+                addRow();
+            }
+            return __values[n * (n + 1) / 2 + k];
+        }
+
+    private:
+        auto addRow() -> void {
+            const std::uint64_t n = __rows_count;
+            const std::uint64_t previous_row = n * (n - 1) / 2;
+            __values.emplace_back(1);
+            for (std::uint64_t k = 1; k < n; ++k) {
+                __values.emplace_back(__values[previous_row + k - 1] + __values[previous_row + k]);
+            }
+            if (n != 0) {
+                __values.emplace_back(1);
+            }
+            __rows_count += 1;
+        }
+
+        std::uint64_t __rows_count = 0;
+        std::vector<std::uint64_t> __values;
+    };
+
+    // Неотрицательное целое произвольной длины. Хранится разрядами по основанию 10^9 от младших
+    // к старшим: произведение двух разрядов влезает в uint64, а вывод в десятичном виде не требует
+    // никаких делений длинного числа.
+    class BigUnsigned {
+    public:
+        using Limb = std::uint32_t;
+
+        BigUnsigned() = default;
+        explicit BigUnsigned(std::uint64_t value) {
+            for (; value != 0; value /= kBase) {
+                __limbs.emplace_back(static_cast<Limb>(value % kBase));
+            }
+        }
+
+        friend auto operator*(const BigUnsigned& a, const BigUnsigned& b) -> BigUnsigned {
+            BigUnsigned result;
+            result.__limbs = multiply(a.__limbs.data(), a.__limbs.size(), b.__limbs.data(), b.__limbs.size());
+            return result;
+        }
+
+        auto toString() const -> std::string {
+            if (__limbs.empty()) {
+                return "0";
+            }
+            std::string result = std::to_string(__limbs.back());
+            result.reserve(result.size() + (__limbs.size() - 1) * kBaseDigits);
+            for (size_t i = __limbs.size() - 1; i-- > 0;) {
+                const auto limb = std::to_string(__limbs[i]);
+                result.append(kBaseDigits - limb.size(), '0');
+                result.append(limb);
+            }
+            return result;
+        }
+
+    private:
+        constexpr static Limb kBase = 1'000'000'000;
+        constexpr static size_t kBaseDigits = 9;
+        // Ниже этого размера умножение в столбик быстрее рекурсии Карацубы
+        constexpr static size_t kKaratsubaThreshold = 32;
+
+        using Limbs = std::vector<Limb>;
+
+        static auto trim(Limbs& limbs) -> void {
+            while (!limbs.empty() && limbs.back() == 0) {
+                limbs.pop_back();
+            }
+        }
+
+        static auto multiplySchoolbook(const Limb* a, const size_t n, const Limb* b, const size_t m) -> Limbs {
+            Limbs result(n + m, 0);
+            for (size_t i = 0; i < n; ++i) {
+                std::uint64_t carry = 0;
+                for (size_t j = 0; j < m; ++j) {
+                    const std::uint64_t current = result[i+j] + static_cast<std::uint64_t>(a[i]) * b[j] + carry;
+                    result[i+j] = static_cast<Limb>(current % kBase);
+                    carry = current / kBase;
+                }
+                result[i+m] = static_cast<Limb>(carry);
+            }
+            trim(result);
+            return result;
+        }
+
+        static auto add(const Limb* a, const size_t n, const Limb* b, const size_t m) -> Limbs {
+            Limbs result(std::max(n, m) + 1, 0);
+            Limb carry = 0;
+            for (size_t i = 0; i < result.size(); ++i) {
+                const Limb current = (i < n ? a[i] : 0) + (i < m ? b[i] : 0) + carry;
+                carry = current >= kBase;
+                result[i] = current - carry * kBase;
+            }
+            trim(result);
+            return result;
+        }
+
+        // target += value * base^shift, места в target должно хватать
+        static auto addShifted(Limbs& target, const Limbs& value, const size_t shift) -> void {
+            Limb carry = 0;
+            for (size_t i = 0; i < value.size() || carry != 0; ++i) {
+                const Limb current = target[shift+i] + (i < value.size() ? value[i] : 0) + carry;
+                carry = current >= kBase;
+                target[shift+i] = current - carry * kBase;
+            }
         }
-        return var;
+
+        // target -= value, при этом target >= value
+        static auto subtract(Limbs& target, const Limbs& value) -> void {
+            Limb borrow = 0;
+            for (size_t i = 0; i < value.size() || borrow != 0; ++i) {
+                const Limb subtrahend = (i < value.size() ? value[i] : 0) + borrow;
+                borrow = target[i] < subtrahend;
+                target[i] = target[i] + borrow * kBase - subtrahend;
+            }
+            trim(target);
+        }
+
+        // Умножение Карацубы: три умножения половинной длины вместо четырех
+        static auto multiply(const Limb* a, const size_t n, const Limb* b, const size_t m) -> Limbs {
+            if (n == 0 || m == 0) {
+                return {};
+            }
+            if (std::min(n, m) < kKaratsubaThreshold) {
+                return multiplySchoolbook(a, n, b, m);
+            }
+
+            const size_t half = std::max(n, m) / 2;
+            // Если одно из чисел короче половины другого, то делим только длинное
+            if (n <= half || m <= half) {
+                const bool is_a_short = n <= half;
+                const Limb* shorter = is_a_short ? a : b;
+                const size_t shorter_size = is_a_short ? n : m;
+                const Limb* longer = is_a_short ? b : a;
+                const size_t longer_size = is_a_short ? m : n;
+
+                Limbs result(n + m + 1, 0);
+                addShifted(result, multiply(shorter, shorter_size, longer, half), 0);
+                addShifted(result, multiply(shorter, shorter_size, longer + half, longer_size - half), half);
+                trim(result);
+                return result;
+            }
+
+            const auto low = multiply(a, half, b, half);
+            const auto high = multiply(a + half, n - half, b + half, m - half);
+            const auto a_sum = add(a, half, a + half, n - half);
+            const auto b_sum = add(b, half, b + half, m - half);
+            auto middle = multiply(a_sum.data(), a_sum.size(), b_sum.data(), b_sum.size());
+            subtract(middle, low);
+            subtract(middle, high);
+
+            Limbs result(n + m + 1, 0);
+            addShifted(result, low, 0);
+            addShifted(result, middle, half);
+            addShifted(result, high, half * 2);
+            trim(result);
+            return result;
+        }
+
+        Limbs __limbs;
+    };
+
+    inline auto mulMod(const std::uint64_t a, const std::uint64_t b, const std::uint64_t modulus) -> std::uint64_t {
+        return static_cast<std::uint64_t>(static_cast<unsigned __int128>(a) * b % modulus);
+    }
+
+    inline auto powMod(std::uint64_t base, std::uint64_t power, const std::uint64_t modulus) -> std::uint64_t {
+        std::uint64_t result = 1 % modulus;
+        for (base %= modulus; power != 0; power >>= 1) {
+            if (power & 1) {
+                result = mulMod(result, base, modulus);
+            }
+            base = mulMod(base, base, modulus);
+        }
+        return result;
+    }
+
+    // Детерминированный тест Миллера-Рабина, этих оснований достаточно для любых uint64
+    inline auto isPrime(const std::uint64_t n) -> bool {
+        if (n < 2) {
+            return false;
+        }
+        constexpr std::uint64_t kBases[] = {2, 3, 5, 7, 11, 13, 17, 19, 23, 29, 31, 37};
+        for (const auto p : kBases) {
+            if (n % p == 0) {
+                return n == p;
+            }
+        }
+        std::uint64_t d = n - 1;
+        size_t s = 0;
+        for (; d % 2 == 0; d /= 2) {
+            s += 1;
+        }
+        for (const auto a : kBases) {
+            std::uint64_t x = powMod(a, d, n);
+            if (x == 1 || x == n - 1) {
+                continue;
+            }
+            bool is_composite = true;
+            for (size_t r = 1; r < s && is_composite; ++r) {
+                x = mulMod(x, x, n);
+                is_composite = x != n - 1;
+            }
+            if (is_composite) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // Биномиальные коэффициенты по простому модулю. Таблицы факториалов и обратных факториалов
+    // считаются один раз, после чего каждый запрос стоит пары умножений. Если n не меньше модуля,
+    // то запрос раскладывается по теореме Люка. Таблицы не больше kMaxTableSize: коэффициенты, до
+    // которых они не достают, считаются напрямую за O(k).
+    class ModularBinomials {
+    public:
+        // 2^22 элементов - по 32 МиБ на каждую из двух таблиц
+        constexpr static std::uint64_t kMaxTableSize = std::uint64_t{1} << 22;
+
+        // max_n = 0 - без таблиц, для одного-двух запросов
+        ModularBinomials(const std::uint64_t modulus, const std::uint64_t max_n)
+            : __modulus(modulus)
+        {
+            if (!isPrime(modulus)) {
+                throw std::invalid_argument("modulus must be prime");
+            }
+            const std::uint64_t table_size = std::min({max_n, modulus - 1, kMaxTableSize - 1}) + 1;
+            __factorials.resize(table_size);
+            __inverse_factorials.resize(table_size);
+
+            __factorials[0] = 1;
+            for (std::uint64_t i = 1; i < table_size; ++i) {
+                __factorials[i] = mulMod(__factorials[i-1], i, modulus);
+            }
+            __inverse_factorials[table_size-1] = powMod(__factorials[table_size-1], modulus - 2, modulus);
+            for (std::uint64_t i = table_size - 1; i > 0; --i) {
+                __inverse_factorials[i-1] = mulMod(__inverse_factorials[i], i, modulus);
+            }
+        }
+
+        auto operator()(std::uint64_t n, std::uint64_t k) const -> std::uint64_t {
+            if (k > n) {
+                return 0;
+            }
+            if (n < __factorials.size()) {
+                return fromTables(n, k);
+            }
+
+            std::uint64_t result = 1 % __modulus;
+            for (; k != 0 && result != 0; n /= __modulus, k /= __modulus) {
+                const auto n_digit = n % __modulus;
+                const auto k_digit = k % __modulus;
+                if (k_digit > n_digit) {
+                    return 0;
+                }
+                const auto digit = n_digit < __factorials.size()
+                    ? fromTables(n_digit, k_digit)
+                    : directly(n_digit, k_digit);
+                result = mulMod(result, digit, __modulus);
+            }
+            return result;
+        }
+
+    private:
+        // C(n, k) для n < модуля как n (n-1) ... (n-k+1) / k!, с одним обращением по малой теореме Ферма
+        auto directly(const std::uint64_t n, std::uint64_t k) const -> std::uint64_t {
+            k = std::min(k, n - k);
+            std::uint64_t numerator = 1 % __modulus;
+            std::uint64_t denominator = 1 % __modulus;
+            for (std::uint64_t i = 1; i <= k; ++i) {
+                numerator = mulMod(numerator, n - k + i, __modulus);
+                denominator = mulMod(denominator, i, __modulus);
+            }
+            return mulMod(numerator, powMod(denominator, __modulus - 2, __modulus), __modulus);
+        }
+
+        auto fromTables(const std::uint64_t n, const std::uint64_t k) const -> std::uint64_t {
+            return mulMod(mulMod(__factorials[n], __inverse_factorials[k], __modulus),
+                          __inverse_factorials[n-k], __modulus);
+        }
+
+        std::uint64_t __modulus;
+        std::vector<std::uint64_t> __factorials;
+        std::vector<std::uint64_t> __inverse_factorials;
+    };
+
+    // Точное значение C(n, k). По формуле Лежандра степень простого p в C(n, k) равна сумме
+    // floor(n/p^i) - floor(k/p^i) - floor((n-k)/p^i), так что число раскладывается на простые
+    // множители без единого деления длинных чисел. Мелкие множители собираются в uint64, а затем
+    // перемножаются попарно деревом, что бы умножения Карацубы работали на числах близкой длины.
+    inline auto exactBinomial(const std::uint64_t n, const std::uint64_t k) -> BigUnsigned {
+        if (k > n) {
+            return BigUnsigned(0);
+        }
+
+        std::vector<bool> is_composite(n + 1, false);
+        std::vector<BigUnsigned> factors;
+        std::uint64_t accumulated = 1;
+        for (std::uint64_t p = 2; p <= n; ++p) {
+            if (is_composite[p]) {
+                continue;
+            }
+            for (std::uint64_t multiple = p * p; multiple <= n; multiple += p) {
+                is_composite[multiple] = true;
+            }
+
+            std::uint64_t power = 0;
+            for (std::uint64_t q = p; q <= n; q *= p) {
+                power += n / q - k / q - (n - k) / q;
+                if (q > n / p) {
+                    break;
+                }
+            }
+            for (; power != 0; --power) {
+                if (accumulated > std::numeric_limits<std::uint64_t>::max() / p) {
+                    factors.emplace_back(accumulated);
+                    accumulated = 1;
+                }
+                accumulated *= p;
+            }
+        }
+        factors.emplace_back(accumulated);
+
+        while (factors.size() > 1) {
+            std::vector<BigUnsigned> next_level;
+            next_level.reserve((factors.size() + 1) / 2);
+            for (size_t i = 0; i + 1 < factors.size(); i += 2) {
+                next_level.emplace_back(factors[i] * factors[i+1]);
+            }
+            if (factors.size() % 2 == 1) {
+                next_level.emplace_back(std::move(factors.back()));
+            }
+            factors = std::move(next_level);
+        }
+        return std::move(factors.front());
     }
 }  // namespace common
 
@@ -67,60 +457,91 @@ namespace solution {
     // Если искомой точки нету в срезе, соответсвующему определенной зоне на карте, значит
     // в такой точке количество маршрутов равно 0.
     //
-    auto solve(const std::uint64_t hieght, const std::uint64_t width) -> std::uint64_t {
-        using Point = std::tuple<std::uint64_t, std::uint64_t>;
-
-        // Номер зоны определить легко. ((x + y) / 3) + 1, где x=w-1, а y=h-1
-        const std::uint64_t diagonale_level = (hieght + width - 2) / 3 + 1;
-
-        // Можно обратить внимание что у крайних точек среза одна из координат равна level-1, а
-        // другая равна (level-1) * 2. Находим такую точку, а зная какое их количество в срезе,
-        // мы просто расчитываем последующие точки двигаясь диагонально
-        std::vector<Point> possible_points(
-            diagonale_level,
-            {diagonale_level-1u, (diagonale_level-1u) * 2u});
-        for (size_t i = 1; i < diagonale_level; ++i) {
-            auto [prev_x, prev_y] = possible_points[i-1];
-            possible_points[i] = {prev_x+1, prev_y-1};
-        }
-
-        // Количество маршрутов для точек среза считаем с помощью метода
-        // мемоизации. Суммируем значения для предыдущих точек и получаем
-        // нужный нам уровень
-        std::vector<std::uint64_t> path_counts(diagonale_level, 1);
-        for (size_t h = 2; h < diagonale_level; ++h) {
-            auto prev_path_counts = path_counts;
-            for (size_t i = 1; i < h; ++i) {
-                path_counts[i] = prev_path_counts[i-1] + prev_path_counts[i];
-            }
-        }
-
-        // Так как все точки и значения их маршрутов лежат в порядке возрастания
-        // координаты x, находим при помощи бинарного поиска нужную нам точку, если
-        // такая кончено же имеется. Иначе считаем что количество маршрутов равно 0
-        auto point_to_find = Point{width-1, hieght-1};
-        auto res = std::lower_bound(
-            possible_points.begin(),
-            possible_points.end(),
-            point_to_find,
-            [](const Point& a, const Point& b) {
-                const auto [ax, _1] = a;
-                const auto [bx, _2] = b;
-                return ax < bx;
-            });
-        if (res != possible_points.end() && *res == point_to_find) {
-            return path_counts[std::distance(possible_points.begin(), res)];
+    // Но если присмотреться к дереву, то это треугольник Паскаля, а значит количество маршрутов
+    // в i-ую точку среза на уровне level равно биномиальному коэффициенту C(level-1, i). Так что
+    // строить весь срез не нужно, достаточно найти номер нужной точки и посчитать одно число.
+    //
+    // У точек среза координаты (level-1+i, (level-1)*2-i), то есть x+y = (level-1)*3. Значит точка
+    // достижима только если x+y делится на 3, а номер точки в срезе равен x-(level-1).
+    //
+    struct PascalPosition {
+        std::uint64_t level;
+        std::uint64_t index;
+    };
+
+    // Возвращает номер уровня (начиная с нуля) и номер точки в срезе, либо ничего, если в точку
+    // нельзя попасть
+    auto getPascalPosition(const std::uint64_t hieght, const std::uint64_t width) -> std::optional<PascalPosition> {
+        if (hieght == 0 || width == 0) {
+            return std::nullopt;
+        }
+        const std::uint64_t x = width - 1;
+        const std::uint64_t y = hieght - 1;
+
+        if ((x + y) % 3 != 0) {
+            return std::nullopt;
         }
+        const std::uint64_t level = (x + y) / 3;
+        if (x < level || x > level * 2) {
+            return std::nullopt;
+        }
+        return PascalPosition{.level = level, .index = x - level};
+    }
+
+    auto solve(const std::uint64_t hieght, const std::uint64_t width) -> std::uint64_t {
         // Для расчета временной сложности используем:
         // d = (w-1 + h-1) / 3 + 1
         //
-        // Этап с вычисление точек для среза по сложности равен: O(d)
-        // 
-        // Этап с вычислением маршрутов для точек в срезе по сложности равен:
-        // O(1 + 2 + 3 + ... + d) = O( (2d+(d-1))/2 * d ) = O(d*d)
-        //
-        // Этап с поиском нужной точки по сложности равен: O(log(d))
-        return 0;
+        // Номер точки находится за O(1), а коэффициент считается за O(min(i, d-i)), но на деле
+        // цикл прерывается переполнением задолго до этого, если ответ не влезает в uint64.
+        const auto position = getPascalPosition(hieght, width);
+        return position ? common::binomial(position->level, position->index) : 0;
+    }
+
+    // Точное количество маршрутов для досок, на которых ответ не влезает в uint64
+    auto solveExact(const std::uint64_t hieght, const std::uint64_t width) -> common::BigUnsigned {
+        const auto position = getPascalPosition(hieght, width);
+        return position ? common::exactBinomial(position->level, position->index) : common::BigUnsigned(0);
+    }
+
+    // Количество маршрутов по модулю, таблицы binomials могут быть общими для множества запросов
+    auto solveModular(
+        const std::uint64_t hieght,
+        const std::uint64_t width,
+        const common::ModularBinomials& binomials) -> std::uint64_t
+    {
+        const auto position = getPascalPosition(hieght, width);
+        return position ? binomials(position->level, position->index) : 0;
+    }
+
+    struct Query {
+        std::uint64_t height;
+        std::uint64_t width;
+    };
+
+    // Отвечает на пачку запросов. Запросы обрабатываются в порядке возрастания уровня, так что
+    // обращения к таблицам идут почти последовательно, а ленивые таблицы растут монотонно.
+    // Ответы при этом складываются в порядке запросов.
+    template <typename Answer, typename Binomial>
+    auto solveBatch(const std::vector<Query>& queries, Binomial&& binomial) -> std::vector<Answer> {
+        std::vector<std::tuple<PascalPosition, size_t>> positions;
+        positions.reserve(queries.size());
+        for (size_t i = 0; i < queries.size(); ++i) {
+            if (const auto position = getPascalPosition(queries[i].height, queries[i].width)) {
+                positions.emplace_back(*position, i);
+            }
+        }
+        std::sort(positions.begin(), positions.end(), [](const auto& a, const auto& b) {
+            const auto& [a_position, _1] = a;
+            const auto& [b_position, _2] = b;
+            return std::tie(a_position.level, a_position.index) < std::tie(b_position.level, b_position.index);
+        });
+
+        std::vector<Answer> answers(queries.size(), Answer(0));
+        for (const auto& [position, i] : positions) {
+            answers[i] = binomial(position.level, position.index);
+        }
+        return answers;
     }
 }  // namespace solution
 
@@ -142,9 +563,158 @@ namespace solution {
 // Пример вывода:
 // > 293930
 
-auto main() -> int {
+// Читает все пары "высота ширина" до конца ввода. Числа разбираются без iostream, так как при
+// миллионах запросов именно это и тормозит.
+auto readQueries(common::InputReader& input) -> std::vector<solution::Query> {
+    std::vector<std::uint64_t> values;
+    while (input.skipSpaces()) {
+        values.emplace_back(common::getFromInput<std::uint64_t>(input));
+    }
+    if (values.size() % 2 != 0) {
+        throw std::runtime_error("Query has no width");
+    }
+
+    std::vector<solution::Query> queries(values.size() / 2);
+    for (size_t i = 0; i < queries.size(); ++i) {
+        queries[i] = solution::Query{.height = values[2*i], .width = values[2*i+1]};
+    }
+    return queries;
+}
+
+template <typename Answer>
+auto writeAnswers(const std::vector<Answer>& answers) -> void {
+    auto& output = common::getStdout();
+    for (const auto& answer : answers) {
+        if constexpr (std::is_same_v<Answer, common::BigUnsigned>) {
+            output.writeText(answer.toString());
+        } else {
+            output.writeNumber(answer);
+        }
+        output.writeSeparator('\n');
+    }
+}
+
+// Пишется вместо ответа пакетного режима, который не влез в uint64: в текстовом формате
+// словом, в двоичном - числом -1
+constexpr std::string_view kOverflowMarker = "overflow";
+constexpr std::int64_t kBinaryOverflowMarker = -1;
+
+// Досчитывать такие ответы точно нельзя: на пачке из больших досок это длинные числа в сотни
+// тысяч цифр на каждый запрос
+auto writeAnswers(const std::vector<std::optional<std::uint64_t>>& answers) -> void {
+    auto& output = common::getStdout();
+    for (const auto& answer : answers) {
+        if (answer) {
+            output.writeNumber(*answer);
+        } else if (output.getFormat() == common::OutputWriter::Format::kBinary) {
+            output.writeNumber(kBinaryOverflowMarker);
+        } else {
+            output.writeText(kOverflowMarker);
+        }
+        output.writeSeparator('\n');
+    }
+}
+
+//
+// Для больших досок ответ не влезает в uint64, поэтому есть дополнительные режимы:
+//   knight_move --exact    - точный ответ произвольной длины
+//   knight_move --mod P    - ответ по простому модулю P
+//
+// Для множества запросов есть пакетный режим, совместимый с любым из режимов выше:
+//   knight_move --batch [FILE]  - пары "высота ширина" до конца файла (или stdin), по ответу в строке
+//
+// Если в пакетном режиме без --exact и --mod ответ не влезает в uint64, вместо него пишется
+// "overflow", а остальные запросы пачки отвечаются как обычно.
+//
+// С флагом --binary ответы пишутся как int64 в little-endian без разделителей; с --exact он
+// несовместим, так как точные ответы в 64 бита не влезают.
+auto main(int argc, char** argv) -> int {
+    enum class Mode { kUInt64, kExact, kModular };
+
+    Mode mode = Mode::kUInt64;
+    std::uint64_t modulus = 0;
+    bool is_batch = false;
+    std::string batch_path;
+    const std::vector<std::string> args(argv + 1, argv + argc);
+    for (size_t i = 0; i < args.size(); ++i) {
+        if (args[i] == "--exact") {
+            mode = Mode::kExact;
+        } else if (args[i] == "--mod" && i + 1 < args.size()) {
+            mode = Mode::kModular;
+            modulus = std::stoull(args[++i]);
+        } else if (args[i] == "--batch") {
+            is_batch = true;
+            if (i + 1 < args.size() && !args[i+1].starts_with("--")) {
+                batch_path = args[++i];
+            }
+        } else if (args[i] == "--binary") {
+            common::getStdout().setFormat(common::OutputWriter::Format::kBinary);
+        } else {
+            throw std::invalid_argument("Usage: knight_move [--exact | --mod P] [--batch [FILE]] [--binary]");
+        }
+    }
+    if (mode == Mode::kExact && common::getStdout().getFormat() == common::OutputWriter::Format::kBinary) {
+        throw std::invalid_argument("Exact answers do not fit into int64, --binary is not supported with --exact");
+    }
+
+    if (is_batch) {
+        std::optional<common::InputReader> file;
+        if (!batch_path.empty()) {
+            file.emplace(batch_path);
+        }
+        const auto queries = readQueries(file ? *file : common::getStdin());
+
+        switch (mode) {
+            case Mode::kUInt64: {
+                // Один ответ, не влезающий в uint64, не должен обрывать всю пачку
+                common::PascalTriangle triangle;
+                const auto answers = solution::solveBatch<std::optional<std::uint64_t>>(
+                    queries,
+                    [&](const std::uint64_t n, const std::uint64_t k) { return triangle.tryGet(n, k); });
+                writeAnswers(answers);
+                break;
+            }
+            case Mode::kExact:
+                writeAnswers(solution::solveBatch<common::BigUnsigned>(queries, common::exactBinomial));
+                break;
+            case Mode::kModular: {
+                // Таблицы строятся один раз под самый дальний запрос
+                std::uint64_t max_level = 0;
+                for (const auto& [height, width] : queries) {
+                    if (const auto position = solution::getPascalPosition(height, width)) {
+                        max_level = std::max(max_level, position->level);
+                    }
+                }
+                const common::ModularBinomials binomials(modulus, max_level);
+                writeAnswers(solution::solveBatch<std::uint64_t>(queries, binomials));
+                break;
+            }
+        }
+        return 0;
+    }
+
     const auto height = common::getFromStdin<std::uint64_t>();
     const auto width = common::getFromStdin<std::uint64_t>();
 
-    std::cout << solution::solve(height, width) << std::endl;
-}
\ No newline at end of file
+    auto& output = common::getStdout();
+    switch (mode) {
+        case Mode::kUInt64:
+            try {
+                output.writeNumber(solution::solve(height, width));
+            } catch (const std::overflow_error&) {
+                std::cerr << "knight_move: the answer does not fit into uint64, use --exact or --mod P" << std::endl;
+                return 1;
+            }
+            break;
+        case Mode::kExact:
+            output.writeText(solution::solveExact(height, width).toString());
+            break;
+        case Mode::kModular: {
+            // Для одного запроса таблицы не окупаются: коэффициент считается напрямую
+            const common::ModularBinomials binomials(modulus, 0);
+            output.writeNumber(solution::solveModular(height, width, binomials));
+            break;
+        }
+    }
+    output.writeSeparator('\n');
+}
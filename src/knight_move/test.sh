@@ -0,0 +1,30 @@
+#!/bin/bash
+# Проверки knight_move на маленьких входах: test.sh ПУТЬ_К_ПРОГРАММЕ
+set -u
+bin=$1
+source "$(dirname "$0")/../common/test.sh"
+
+check "example" $'31 34\n' "293930"
+check "unreachable" $'2 2\n' "0"
+check "exact" $'31 34\n' "293930" --exact
+check "modular" $'31 34\n' "293930" --mod 1000000007
+
+# Огромные доски по модулю: недостижимая - сразу ноль, достижимая считается без таблиц на весь уровень
+check "modular huge unreachable" $'3000000000 3000000000\n' "0" --mod 1000000007
+check "modular huge" $'1999000001 1001000001\n' "336556208" --mod 1000000007
+check "modular huge batch" $'1999000001 1001000001\n31 34\n' $'336556208\n293930' --mod 1000000007 --batch
+
+# Ответ не влезает в uint64: понятная ошибка и ненулевой код выхода вместо std::terminate
+checkError "overflow" $'1000 1000\n' "use --exact or --mod P"
+
+# Беззнаковые числа с минусом отвергаются (std::cin заворачивал их через 2^64), а "+" допустим
+checkError "negative size" $'-31 34\n' "Failed to read value from stdin"
+checkError "negative batch size" $'31 34\n-3 2\n' "Failed to read value from stream" --batch
+check "plus sign" $'+31 34\n' "293930"
+
+check "batch" $'31 34\n2 2\n3 2\n' $'293930\n0\n1' --batch
+
+# В пакетном режиме переполнение одного запроса не обрывает остальные
+check "batch overflow" $'31 34\n1000 1000\n3 2\n' $'293930\noverflow\n1' --batch
+
+finish
@@ -1,162 +1,706 @@
 #include <algorithm>
+#include <bit>
+#include <chrono>
 #include <cstdint>
-#include <iostream>
+#include <limits>
+#include <numeric>
+#include <optional>
+#include <random>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <utility>
 #include <vector>
-#include <iterator>
-
-namespace common {
-    template <typename T>
-    concept ReservableEmplacableContainer = requires (T c) {
-        typename T::value_type;
-        c.reserve(size_t{0});
-        c.emplace_back();
+#include <span>
+#include <stdexcept>
+
+#include "common/input.h"
+#include "common/matrix.h"
+#include "common/output.h"
+#include "common/thread_pool.h"
+
+namespace solution {
+    using Sequence = std::vector<std::int64_t>;
+    using SequenceView = std::span<const std::int64_t>;
+
+    // Заполнение матрицы длин НОП волновым фронтом.
+    //
+    // Клетка зависит только от левой, верхней и диагональной, поэтому клетки одной антидиагонали
+    // независимы. Считать по одной клетке на поток бессмысленно, так что матрица режется на блоки
+    // размером с кэш, а блоки одной антидиагонали блоков (фронта) считаются параллельно. Внутри блока
+    // обход обычный, построчный. Результат совпадает с последовательным заполнением клетка в клетку.
+    constexpr size_t kWavefrontBlockSize = 256;
+
+    // Длины НОП не превышают длины более короткой последовательности, так что тип клетки выбирается
+    // по ней (см. common::dispatchCellType). Для волнового фронта матрица хранится блоками размером
+    // с блок фронта, чтобы блок целиком лежал в памяти подряд.
+    template <typename Cell, typename Layout, typename Storage = common::VectorStorage<Cell>>
+    using LcsMatrix = common::Matrix<Cell, Layout, Storage, common::UncheckedAccess>;
+
+    using WavefrontLayout = common::TiledLayout<kWavefrontBlockSize>;
+
+    // Где держать матрицу: в памяти или в отображенном в память временном файле
+    enum class MatrixStorage {
+        kMemory,
+        kFile,
     };
 
-    template <typename Value>
-    auto getFromStdin() -> Value {
-        Value var;
-        std::cin >> var;
-        if (!std::cin.good()) {
-            throw std::runtime_error("Failed to read value from stdin");
+    template <typename Map>
+    auto fillMatrix(
+        Map& map,
+        const SequenceView s1,
+        const SequenceView s2,
+        common::ThreadPool* pool) -> void
+    {
+        using Cell = std::remove_cvref_t<decltype(map(0, 0))>;
+
+        // Блок фронта совпадает с блоком раскладки (или лежит в строке построчной матрицы), так что
+        // каждая его строка лежит в памяти подряд. Левый и диагональный соседи первой клетки строки
+        // берутся из соседнего блока отдельно.
+        const auto fill_block = [&](const size_t i_begin, const size_t i_end, const size_t j_begin, const size_t j_end) {
+            for (size_t i = std::max<size_t>(i_begin, 1); i < i_end; ++i) {
+                Cell* current = &map(i, j_begin);
+                const Cell* previous = &map(i-1, j_begin);
+                Cell left = j_begin == 0 ? 0 : map(i, j_begin-1);
+                Cell diagonal = j_begin == 0 ? 0 : map(i-1, j_begin-1);
+                const auto symbol = s1[i-1];
+                for (size_t j = j_begin; j < j_end; ++j) {
+                    const Cell up = previous[j - j_begin];
+                    if (j != 0) {
+                        left = (symbol == s2[j-1])
+                            ? static_cast<Cell>(diagonal + 1)
+                            : std::max(up, left);
+                    }
+                    current[j - j_begin] = left;
+                    diagonal = up;
+                }
+            }
+        };
+
+        // Построчную матрицу без пула заполняем одним блоком во всю матрицу
+        if constexpr (requires { map.getRow(0); }) {
+            if (pool == nullptr || pool->getThreadsCount() == 1) {
+                fill_block(0, map.getHeight(), 0, map.getWidth());
+                return;
+            }
+        }
+
+        const size_t block_rows = (map.getHeight() + kWavefrontBlockSize - 1) / kWavefrontBlockSize;
+        const size_t block_columns = (map.getWidth() + kWavefrontBlockSize - 1) / kWavefrontBlockSize;
+        for (size_t front = 0; front < block_rows + block_columns - 1; ++front) {
+            const size_t first_block_row = front < block_columns ? 0 : front - block_columns + 1;
+            const size_t last_block_row = std::min(front, block_rows - 1);
+            const auto fill_front_block = [&](const size_t k) {
+                const size_t block_row = first_block_row + k;
+                const size_t block_column = front - block_row;
+                fill_block(
+                    block_row * kWavefrontBlockSize,
+                    std::min((block_row + 1) * kWavefrontBlockSize, map.getHeight()),
+                    block_column * kWavefrontBlockSize,
+                    std::min((block_column + 1) * kWavefrontBlockSize, map.getWidth()));
+            };
+            if (pool != nullptr) {
+                pool->run(last_block_row - first_block_row + 1, fill_front_block);
+            } else {
+                for (size_t k = 0; k <= last_block_row - first_block_row; ++k) {
+                    fill_front_block(k);
+                }
+            }
         }
-        return var;
     }
 
-    template <ReservableEmplacableContainer Collection, typename ... Args>
-    auto getFromStdin(const size_t n, Args ... ns) -> Collection {
-        Collection collection;
-        collection.reserve(n);
-        for (size_t i = 0; i < n; ++i) {
-            collection.emplace_back(
-                getFromStdin<typename Collection::value_type>(ns...));
+    template <typename Map>
+    auto restoreFromMatrix(const Map& map, const SequenceView s1) -> Sequence {
+        Sequence sub;
+        sub.reserve(std::min(map.getHeight(), map.getWidth()) - 1);
+
+        size_t i = map.getHeight()-1;
+        size_t j = map.getWidth()-1;
+        for (;;) {
+            if (const auto current_len = map(i, j); current_len != 0) {
+                while (map(i-1, j) == current_len) {
+                    i -= 1;
+                }
+                while (map(i, j-1) == current_len) {
+                    j -= 1;
+                }
+                sub.emplace_back(s1[i-1]);
+                i -= 1;
+                j -= 1;
+            } else {
+                break;
+            }
         }
-        return collection;
+        std::reverse(sub.begin(), sub.end());
+        return sub;
     }
 
-    template <std::unsigned_integral I>
-    auto safeUMull(const I x, const I y) -> I {
-        const I result = x*y;
-        if (x != 0 && result/x != y) {
-            throw std::overflow_error("overflowed unsigned multiplication");
+    template <typename Cell, typename Storage>
+    auto solveWithMatrixIn(
+        const SequenceView s1,
+        const SequenceView s2,
+        common::ThreadPool* pool) -> Sequence
+    {
+        if (pool != nullptr && pool->getThreadsCount() > 1) {
+            LcsMatrix<Cell, WavefrontLayout, Storage> map(s1.size()+1, s2.size()+1);
+            fillMatrix(map, s1, s2, pool);
+            return restoreFromMatrix(map, s1);
         }
-        return result;
+        LcsMatrix<Cell, common::RowMajorLayout, Storage> map(s1.size()+1, s2.size()+1);
+        fillMatrix(map, s1, s2, nullptr);
+        return restoreFromMatrix(map, s1);
     }
 
-    template <typename Type>
-    class Matrix {
+    auto getMatrixCellBytes(const SequenceView s1, const SequenceView s2) -> size_t {
+        return common::dispatchCellType(std::min(s1.size(), s2.size()), []<typename Cell>(std::type_identity<Cell>) {
+            return sizeof(Cell);
+        });
+    }
+
+    // Классическое решение: заполняем всю матрицу длин НОП для префиксов и восстанавливаем
+    // подпоследовательность обратным ходом. Памяти нужно O(n*m), так что годится только для
+    // небольших входов. С пулом потоков матрица заполняется волновым фронтом.
+    auto solveWithMatrix(
+        const SequenceView s1,
+        const SequenceView s2,
+        common::ThreadPool* pool = nullptr,
+        const MatrixStorage storage = MatrixStorage::kMemory) -> Sequence
+    {
+        return common::dispatchCellType(std::min(s1.size(), s2.size()), [&]<typename Cell>(std::type_identity<Cell>) {
+            if (storage == MatrixStorage::kFile) {
+                return solveWithMatrixIn<Cell, common::MmapStorage<Cell>>(s1, s2, pool);
+            }
+            return solveWithMatrixIn<Cell, common::VectorStorage<Cell>>(s1, s2, pool);
+        });
+    }
+
+    // Битово-параллельный подсчет длин НОП (Allison-Dix, Hyyrö).
+    //
+    // Строка длин матрицы вдоль s2 кодируется битовым вектором V: j-й бит равен нулю, если длина НОП
+    // растет на единицу на j-м элементе s2. Переход к следующей строке для элемента c из s1 это
+    // V' = (V + (V & M[c])) | (V & ~M[c]), где M[c] - маска позиций s2, на которых стоит c. Так
+    // строка считается за несколько операций на каждые 64 клетки, а длина НОП это число нулей в V.
+    //
+    // Значения int64 сжимаются в плотные номера символов. Если таблица масок "символ x слова" мала,
+    // то она строится целиком, иначе храним для каждого символа только список позиций и собираем
+    // маску строки на лету, что при большом алфавите даже дешевле.
+    //
+    // С пулом потоков строки считаются волновым фронтом, как и полная матрица: слово V зависит от
+    // того же слова на предыдущей строке и от переноса из предыдущего слова на этой строке. Поэтому
+    // прямоугольник "строки x слова" режется на блоки, перенос на границе блоков хранится для каждой
+    // строки отдельно, а блоки одной антидиагонали считаются параллельно.
+    class BitParallelLcs {
     public:
-        Matrix(const size_t height, const size_t width, const Type& default_value = Type{})
-            : __data(safeUMull(height, width), default_value)
-            , __h(height)
-            , __w(width)
-        {
+        // Строит маски совпадений по s2, итераторы могут быть развернутыми для обратного прохода
+        template <typename Iterator>
+        auto reset(const Iterator s2_begin, const Iterator s2_end) -> void {
+            __width = static_cast<size_t>(std::distance(s2_begin, s2_end));
+            __words = (__width + kWordBits - 1) / kWordBits;
+
+            __symbols.assign(s2_begin, s2_end);
+            std::sort(__symbols.begin(), __symbols.end());
+            __symbols.erase(std::unique(__symbols.begin(), __symbols.end()), __symbols.end());
+
+            __is_dense = __symbols.size() * __words <= kMaxDenseMaskWords;
+            if (__is_dense) {
+                __dense_masks.assign(__symbols.size() * __words, 0);
+                size_t j = 0;
+                for (auto it = s2_begin; it != s2_end; ++it, ++j) {
+                    __dense_masks[findSymbol(*it) * __words + j / kWordBits] |= std::uint64_t{1} << (j % kWordBits);
+                }
+            } else {
+                // Позиции группируем по символам подсчетом, как в CSR
+                __positions_offsets.assign(__symbols.size() + 1, 0);
+                for (auto it = s2_begin; it != s2_end; ++it) {
+                    __positions_offsets[findSymbol(*it) + 1] += 1;
+                }
+                std::partial_sum(__positions_offsets.begin(), __positions_offsets.end(), __positions_offsets.begin());
+                __positions.resize(__width);
+                auto fill_offsets = __positions_offsets;
+                size_t j = 0;
+                for (auto it = s2_begin; it != s2_end; ++it, ++j) {
+                    __positions[fill_offsets[findSymbol(*it)]++] = j;
+                }
+                __row_mask.assign(__words, 0);
+            }
+            __v.assign(__words, ~std::uint64_t{0});
         }
 
-        Matrix() = delete;
-        Matrix(const Matrix&) = delete;
-        Matrix(Matrix&&) = delete;
+        // Прогоняет строки для элементов s1 начиная со строки, на которой остановились ранее
+        template <typename Iterator>
+        auto run(const Iterator s1_begin, const Iterator s1_end, common::ThreadPool* pool = nullptr) -> void {
+            const size_t height = static_cast<size_t>(std::distance(s1_begin, s1_end));
+            if (pool == nullptr || pool->getThreadsCount() == 1 || height * __words < kMinWavefrontWords) {
+                for (auto it = s1_begin; it != s1_end; ++it) {
+                    applyRow(findSymbol(*it), 0, __words, 0);
+                }
+                return;
+            }
 
-    private:
-        auto checkHeightWidth(const size_t h, const size_t w) const -> void {
-            if (h >= getHeight() || w >= getWidth()) {
-                throw std::out_of_range("invalid indecies to access matrix");
+            __row_symbols.resize(height);
+            for (size_t i = 0; i < height; ++i) {
+                __row_symbols[i] = findSymbol(s1_begin[i]);
+            }
+            __carries.assign(height, 0);
+
+            const size_t block_rows = (height + kWavefrontRows - 1) / kWavefrontRows;
+            const size_t block_columns = (__words + kWavefrontWords - 1) / kWavefrontWords;
+            for (size_t front = 0; front < block_rows + block_columns - 1; ++front) {
+                const size_t first_block_row = front < block_columns ? 0 : front - block_columns + 1;
+                const size_t last_block_row = std::min(front, block_rows - 1);
+                pool->run(last_block_row - first_block_row + 1, [&](const size_t k) {
+                    const size_t block_row = first_block_row + k;
+                    const size_t block_column = front - block_row;
+                    const size_t w_begin = block_column * kWavefrontWords;
+                    const size_t w_end = std::min(w_begin + kWavefrontWords, __words);
+                    const size_t i_end = std::min((block_row + 1) * kWavefrontRows, height);
+                    for (size_t i = block_row * kWavefrontRows; i < i_end; ++i) {
+                        __carries[i] = applyRow(__row_symbols[i], w_begin, w_end, __carries[i]);
+                    }
+                });
             }
         }
 
-        auto unchekedAt(const size_t i, const size_t j) -> Type& {
-            return __data[i * getWidth() + j];
+        auto getLength() const -> size_t {
+            size_t ones = 0;
+            for (size_t w = 0; w < __words; ++w) {
+                ones += std::popcount(__v[w] & getWordMask(w));
+            }
+            return __width - ones;
         }
 
-        auto unchekedAt(const size_t i, const size_t j) const -> const Type& {
-            return __data[i * getWidth() + j];
+        // row[j] - длина НОП с первыми j элементами s2 (в порядке итераторов из reset)
+        auto getPrefixLengths(std::vector<size_t>& row) const -> void {
+            row.resize(__width + 1);
+            row[0] = 0;
+            size_t zeros = 0;
+            for (size_t j = 0; j < __width; ++j) {
+                zeros += ((__v[j / kWordBits] >> (j % kWordBits)) & 1u) ^ 1u;
+                row[j+1] = zeros;
+            }
         }
 
-    public:
-        auto operator()(const size_t i, const size_t j) -> Type& {
-            checkHeightWidth(i, j);
-            return unchekedAt(i, j);
+    private:
+        constexpr static size_t kWordBits = 64;
+        constexpr static size_t kNoSymbol = std::numeric_limits<size_t>::max();
+        // 32 MiB на таблицу масок
+        constexpr static size_t kMaxDenseMaskWords = size_t{1} << 22;
+        // Блок волнового фронта: 2048 строк на 1024 столбца s2, порядка десятков микросекунд работы
+        constexpr static size_t kWavefrontRows = 2048;
+        constexpr static size_t kWavefrontWords = 16;
+        // Волновой фронт окупается от 4M клеток, как и для полной матрицы
+        constexpr static size_t kMinWavefrontWords = (size_t{1} << 22) / kWordBits;
+
+        auto findSymbol(const std::int64_t value) const -> size_t {
+            const auto it = std::lower_bound(__symbols.begin(), __symbols.end(), value);
+            return (it != __symbols.end() && *it == value) ? static_cast<size_t>(it - __symbols.begin()) : kNoSymbol;
         }
 
-        auto operator()(const size_t i, const size_t j) const -> const Type& {
-            checkHeightWidth(i, j);
-            return unchekedAt(i, j);
+        auto getWordMask(const size_t w) const -> std::uint64_t {
+            const size_t bits = std::min(kWordBits, __width - w * kWordBits);
+            return bits == kWordBits ? ~std::uint64_t{0} : (std::uint64_t{1} << bits) - 1;
         }
 
-        auto getHeight() const -> size_t {
-            return __h;
+        // Переход к следующей строке на словах [w_begin, w_end) с входящим переносом, возвращает
+        // перенос из последнего слова. Сложение идет через все слова с переносом, остальные операции
+        // поразрядные.
+        auto applyRow(const size_t symbol, const size_t w_begin, const size_t w_end, std::uint64_t carry) -> std::uint64_t {
+            // Символа нет в s2, значит и строка длин не меняется
+            if (symbol == kNoSymbol) {
+                return carry;
+            }
+            if (__is_dense) {
+                return addRow(__dense_masks.data() + symbol * __words, w_begin, w_end, carry);
+            }
+            // Позиции символа отсортированы, так что в маску попадают только те, что в словах блока
+            const auto first = std::lower_bound(
+                __positions.begin() + __positions_offsets[symbol],
+                __positions.begin() + __positions_offsets[symbol+1],
+                w_begin * kWordBits);
+            const auto last = std::lower_bound(
+                first, __positions.begin() + __positions_offsets[symbol+1], w_end * kWordBits);
+            for (auto p = first; p != last; ++p) {
+                __row_mask[*p / kWordBits] |= std::uint64_t{1} << (*p % kWordBits);
+            }
+            carry = addRow(__row_mask.data(), w_begin, w_end, carry);
+            for (auto p = first; p != last; ++p) {
+                __row_mask[*p / kWordBits] = 0;
+            }
+            return carry;
         }
 
-        auto getWidth() const -> size_t {
-            return __w;
+        auto addRow(const std::uint64_t* match, const size_t w_begin, const size_t w_end, std::uint64_t carry) -> std::uint64_t {
+            for (size_t w = w_begin; w < w_end; ++w) {
+                const std::uint64_t v = __v[w];
+                const std::uint64_t u = v & match[w];
+                const std::uint64_t partial = v + u;
+                const std::uint64_t sum = partial + carry;
+                carry = (partial < v) | (sum < partial);
+                __v[w] = sum | (v & ~match[w]);
+            }
+            return carry;
         }
 
-        template <typename Func>
-            requires requires (Func f, Type& val) {
-                { f(0, 0, val) } -> std::same_as<void>;
+        size_t __width = 0;
+        size_t __words = 0;
+        std::vector<std::int64_t> __symbols;
+        bool __is_dense = true;
+        std::vector<std::uint64_t> __dense_masks;
+        std::vector<size_t> __positions_offsets;
+        std::vector<size_t> __positions;
+        std::vector<std::uint64_t> __row_mask;
+        std::vector<std::uint64_t> __v;
+        std::vector<size_t> __row_symbols;
+        std::vector<std::uint64_t> __carries;
+    };
+
+    // Только длина НОП, без восстановления, за O(n*m/64)
+    auto solveLength(SequenceView s1, SequenceView s2, common::ThreadPool* pool = nullptr) -> size_t {
+        if (s2.size() > s1.size()) {
+            std::swap(s1, s2);
+        }
+        BitParallelLcs lcs;
+        lcs.reset(s2.begin(), s2.end());
+        lcs.run(s1.begin(), s1.end(), pool);
+        return lcs.getLength();
+    }
+
+    // Алгоритм Хиршберга: НОП восстанавливается по принципу "разделяй и властвуй", а в памяти
+    // держатся только строки длин размером с более короткую последовательность.
+    //
+    // Делим s1 пополам. Для верхней половины прямым проходом считаем длины НОП с каждым префиксом s2,
+    // а для нижней половины обратным проходом с каждым суффиксом s2. Точка k, в которой сумма этих
+    // длин максимальна, это место, где оптимальный путь пересекает середину s1, так что дальше
+    // независимо решаем две задачи (верх s1, s2[0,k)) и (низ s1, s2[k,m)).
+    //
+    // С пулом потоков строки длин больших задач считаются волновым фронтом (см. BitParallelLcs),
+    // так что параллельность доступна и на входах, для которых полная матрица не помещается в память.
+    class HirschbergSolver {
+    public:
+        // Задачи меньше этого количества клеток дешевле решать полной матрицей
+        constexpr static size_t kMatrixCellsThreshold = 1 << 12;
+
+        explicit HirschbergSolver(common::ThreadPool* pool = nullptr)
+            : __pool(pool)
+        {}
+
+        auto operator()(SequenceView s1, SequenceView s2) -> Sequence {
+            // Строки длин идут вдоль s2, поэтому пусть она будет короче
+            if (s2.size() > s1.size()) {
+                std::swap(s1, s2);
             }
-        auto forEach(Func f) {
-            const size_t h = getHeight();
-            const size_t w = getWidth();
-            for (size_t i = 0; i < h; ++i) {
-                for (size_t j = 0; j < w; ++j) {
-                    f(i, j, unchekedAt(i, j));
+            Sequence sub;
+            sub.reserve(s2.size());
+            solve(s1, s2, sub);
+            return sub;
+        }
+
+    private:
+        auto solve(const SequenceView s1, const SequenceView s2, Sequence& sub) -> void {
+            if (s1.empty() || s2.empty()) {
+                return;
+            }
+            // Одну строку пополам уже не поделить, но для нее ответ очевиден
+            if (s1.size() == 1) {
+                if (std::find(s2.begin(), s2.end(), s1.front()) != s2.end()) {
+                    sub.emplace_back(s1.front());
                 }
+                return;
             }
+            if ((s1.size()+1) * (s2.size()+1) <= kMatrixCellsThreshold) {
+                const auto part = solveWithMatrix(s1, s2);
+                sub.insert(sub.end(), part.begin(), part.end());
+                return;
+            }
+
+            const size_t middle = s1.size() / 2;
+            const auto top = s1.first(middle);
+            const auto bottom = s1.subspan(middle);
+            // Строки длин считаем битово-параллельно, для нижней половины по развернутым последовательностям
+            __lcs.reset(s2.begin(), s2.end());
+            __lcs.run(top.begin(), top.end(), __pool);
+            __lcs.getPrefixLengths(__forward_row);
+            __lcs.reset(s2.rbegin(), s2.rend());
+            __lcs.run(bottom.rbegin(), bottom.rend(), __pool);
+            __lcs.getPrefixLengths(__backward_row);
+
+            size_t split = 0;
+            size_t best_len = 0;
+            for (size_t k = 0; k <= s2.size(); ++k) {
+                const size_t len = __forward_row[k] + __backward_row[s2.size()-k];
+                if (len > best_len) {
+                    best_len = len;
+                    split = k;
+                }
+            }
+
+            solve(top, s2.first(split), sub);
+            solve(bottom, s2.subspan(split), sub);
         }
 
-    private:
-        std::vector<Type> __data;
-        const size_t __h;
-        const size_t __w;
+        common::ThreadPool* __pool;
+        BitParallelLcs __lcs;
+        std::vector<size_t> __forward_row;
+        std::vector<size_t> __backward_row;
     };
-}  // namespace common
 
-namespace solution {
-    auto solve(
-        const std::vector<std::int64_t>& s1,
-        const std::vector<std::int64_t>& s2
-    ) -> std::vector<std::int64_t> {
-        common::Matrix<size_t> map(s1.size()+1, s2.size()+1, 0ull);
-
-        map.forEach(
-            [&](const size_t i, const size_t j, size_t& value) {
-                if (i != 0 && j != 0) {
-                    value = (s1[i-1] == s2[j-1])
-                        ? map(i-1, j-1) + 1
-                        : std::max(map(i-1, j),
-                                map(i, j-1));
+    // Алгоритм Ханта-Шиманского для входов с малым количеством совпадений r.
+    //
+    // Позиции s2 группируются по значению. Для каждого элемента s1 перебираем позиции s2 с тем же
+    // значением в порядке убывания и ведем, как при поиске наибольшей возрастающей подпоследовательности,
+    // массив порогов: thresholds[k] - минимальная позиция в s2, которой может заканчиваться общая
+    // подпоследовательность длины k+1. Убывающий порядок не дает взять два совпадения для одного
+    // элемента s1. Итого O((r + n) log n) времени и O(r) памяти в худшем случае.
+    //
+    // Каждое обновление порога запоминается в списке своей длины. Порог длины k+1 после строки i - это
+    // минимальная позиция среди обновлений этой длины в строках до i включительно, так что по спискам
+    // можно повторить обратный ход полной матрицы: с конца берем самую раннюю строку, в которой цепочка
+    // нужной длины уже помещается левее предыдущего совпадения, а в ней самую левую позицию. Поэтому
+    // ответ совпадает с restoreFromMatrix, а не только по длине.
+    auto solveSparse(const SequenceView s1, const SequenceView s2) -> Sequence {
+        std::vector<size_t> positions(s2.size());
+        std::iota(positions.begin(), positions.end(), 0);
+        std::stable_sort(positions.begin(), positions.end(), [&](const size_t a, const size_t b) {
+            return s2[a] < s2[b];
+        });
+
+        struct Match {
+            size_t s1_index;
+            size_t s2_index;
+        };
+        // updates[k] - обновления порога длины k+1 по возрастанию строк, внутри строки по убыванию позиций
+        std::vector<std::vector<Match>> updates;
+        std::vector<size_t> thresholds;
+
+        for (size_t i = 0; i < s1.size(); ++i) {
+            const auto [first, last] = std::equal_range(
+                positions.begin(), positions.end(), s1[i],
+                [&](const auto& a, const auto& b) {
+                    if constexpr (std::is_same_v<std::decay_t<decltype(a)>, size_t>) {
+                        return s2[a] < b;
+                    } else {
+                        return a < s2[b];
+                    }
+                });
+
+            for (auto it = last; it != first;) {
+                const size_t j = *--it;
+                const auto threshold = std::lower_bound(thresholds.begin(), thresholds.end(), j);
+                const size_t k = static_cast<size_t>(threshold - thresholds.begin());
+                if (threshold == thresholds.end()) {
+                    thresholds.emplace_back(j);
+                    updates.emplace_back();
+                } else if (*threshold == j) {
+                    continue;
                 } else {
-                    value = 0;
+                    *threshold = j;
                 }
+                updates[k].emplace_back(Match{.s1_index = i, .s2_index = j});
+            }
+        }
+
+        // Каждый список просматривается не больше одного раза, так что обратный ход стоит O(r)
+        Sequence sub(updates.size());
+        size_t s2_limit = s2.size();
+        for (size_t k = updates.size(); k-- > 0;) {
+            const auto& matches = updates[k];
+            auto match = std::find_if(matches.begin(), matches.end(), [&](const Match& m) {
+                return m.s2_index < s2_limit;
             });
+            while (std::next(match) != matches.end() && std::next(match)->s1_index == match->s1_index) {
+                ++match;
+            }
+            sub[k] = s1[match->s1_index];
+            s2_limit = match->s2_index;
+        }
+        return sub;
+    }
 
-        std::vector<std::int64_t> sub;
-        sub.reserve(std::min(s1.size(), s2.size()));
+    // Количество пар (i, j) с s1[i] == s2[j], то есть число совпадений r. Считается по
+    // отсортированным копиям за O((n + m) log(n + m)), при переполнении насыщается.
+    auto estimateMatchesCount(const SequenceView s1, const SequenceView s2) -> size_t {
+        Sequence sorted1(s1.begin(), s1.end());
+        Sequence sorted2(s2.begin(), s2.end());
+        std::sort(sorted1.begin(), sorted1.end());
+        std::sort(sorted2.begin(), sorted2.end());
 
-        size_t i = map.getHeight()-1;
-        size_t j = map.getWidth()-1;
-        for (;;) {
-            if (const size_t current_len = map(i, j); current_len != 0) {
-                while (map(i-1, j) == current_len) {
-                    i -= 1;
-                }
-                while (map(i, j-1) == current_len) {
-                    j -= 1;
-                }
-                sub.emplace_back(s1[i-1]);
-                i -= 1;
-                j -= 1;
+        size_t matches = 0;
+        auto it1 = sorted1.begin();
+        auto it2 = sorted2.begin();
+        while (it1 != sorted1.end() && it2 != sorted2.end()) {
+            if (*it1 < *it2) {
+                it1 = std::upper_bound(it1, sorted1.end(), *it1);
+            } else if (*it2 < *it1) {
+                it2 = std::upper_bound(it2, sorted2.end(), *it2);
             } else {
-                break;
+                const auto end1 = std::upper_bound(it1, sorted1.end(), *it1);
+                const auto end2 = std::upper_bound(it2, sorted2.end(), *it2);
+                const size_t count1 = static_cast<size_t>(end1 - it1);
+                const size_t count2 = static_cast<size_t>(end2 - it2);
+                if (count2 != 0 && count1 > (std::numeric_limits<size_t>::max() - matches) / count2) {
+                    return std::numeric_limits<size_t>::max();
+                }
+                matches += count1 * count2;
+                it1 = end1;
+                it2 = end2;
             }
         }
-        std::reverse(sub.begin(), sub.end());
-        return sub;
+        return matches;
+    }
+
+    enum class Engine {
+        kAuto,
+        kMatrix,
+        kHirschberg,
+        kSparse,
+    };
+
+    // Если полная матрица укладывается в этот объем, то используем ее, иначе Хиршберга
+    constexpr size_t kMaxMatrixBytes = size_t{256} << 20;
+
+    // Волновой фронт окупается только на матрицах из многих блоков
+    constexpr size_t kMinWavefrontCells = size_t{1} << 22;
+
+    // Выбор движка по размеру входа и оценке количества совпадений. Разреженный движок тратит
+    // порядка log(n) на каждое совпадение, плотные - порядка 1/16 на клетку матрицы с учетом
+    // битовой параллельности и двух проходов Хиршберга.
+    auto chooseEngine(const SequenceView s1, const SequenceView s2) -> Engine {
+        const size_t cells = (s1.size()+1) * (s2.size()+1);
+        const bool is_matrix_overflowed = (s1.size()+1) != 0 && cells / (s1.size()+1) != (s2.size()+1);
+        const size_t dense_cost = is_matrix_overflowed ? std::numeric_limits<size_t>::max() / 16 : cells / 16;
+
+        const size_t matches = estimateMatchesCount(s1, s2);
+        const size_t log_n = std::bit_width(std::min(s1.size(), s2.size()) + 1);
+        if (matches <= dense_cost / log_n) {
+            return Engine::kSparse;
+        }
+        if (!is_matrix_overflowed && cells <= kMaxMatrixBytes / getMatrixCellBytes(s1, s2)) {
+            return Engine::kMatrix;
+        }
+        return Engine::kHirschberg;
+    }
+
+    auto solve(
+        const SequenceView s1,
+        const SequenceView s2,
+        common::ThreadPool& pool,
+        Engine engine = Engine::kAuto,
+        const MatrixStorage storage = MatrixStorage::kMemory) -> Sequence
+    {
+        if (engine == Engine::kAuto) {
+            engine = chooseEngine(s1, s2);
+        }
+        switch (engine) {
+            case Engine::kAuto:
+            case Engine::kMatrix: {
+                const size_t cells = common::safeUMull(s1.size()+1, s2.size()+1);
+                return solveWithMatrix(s1, s2, cells >= kMinWavefrontCells ? &pool : nullptr, storage);
+            }
+            case Engine::kHirschberg:
+                return HirschbergSolver(&pool)(s1, s2);
+            case Engine::kSparse:
+                return solveSparse(s1, s2);
+        }
+        return {};
     }
 }  // namespace solution
 
+// Замер ускорения волнового фронта от количества потоков на случайных последовательностях. Движок
+// выбирается как в auto: полная матрица, если она помещается в память, иначе Хиршберг с волновым
+// фронтом по строкам длин. Время включает восстановление НОП. Потоков берется 1, 2, 4, ... и max_threads.
+auto runBenchmark(const size_t n, const size_t m, const size_t max_threads) -> void {
+    std::mt19937_64 random(42);
+    std::uniform_int_distribution<std::int64_t> values(0, 15);
+    const auto make_sequence = [&](const size_t len) {
+        solution::Sequence sequence(len);
+        std::generate(sequence.begin(), sequence.end(), [&]() { return values(random); });
+        return sequence;
+    };
+    const auto s1 = make_sequence(n);
+    const auto s2 = make_sequence(m);
+
+    const auto engine = solution::chooseEngine(s1, s2);
+    std::vector<size_t> threads_counts;
+    for (size_t threads = 1; threads < max_threads; threads *= 2) {
+        threads_counts.emplace_back(threads);
+    }
+    threads_counts.emplace_back(max_threads);
+
+    // Таблица для человека, поэтому всегда текстом. Каждая строка сбрасывается сразу, что бы
+    // долгий замер было видно по ходу.
+    auto& output = common::getStdout();
+    output.setFormat(common::OutputWriter::Format::kText);
+    double single_thread_seconds = 0;
+    output.writeText("lcs ").writeNumber(n).writeText("x").writeNumber(m)
+        .writeText(engine == solution::Engine::kMatrix ? ", full matrix\n" : ", hirschberg\n");
+    output.writeText("threads\tseconds\tspeedup\n");
+    output.flush();
+    for (const auto threads : threads_counts) {
+        common::ThreadPool pool(threads);
+        const auto started = std::chrono::steady_clock::now();
+        solution::solve(s1, s2, pool, engine);
+        const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - started;
+        if (threads == 1) {
+            single_thread_seconds = elapsed.count();
+        }
+        output.writeNumber(threads).writeText("\t").writeNumber(elapsed.count())
+            .writeText("\t").writeNumber(single_thread_seconds / elapsed.count()).writeText("\n");
+        output.flush();
+    }
+}
+
 // https://coderun.yandex.ru/problem/nop-with-response-recovery
-auto main() -> int {
+//
+// Флаги:
+//   --length-only   - напечатать только длину НОП
+//   --engine NAME   - auto (по умолчанию), matrix, hirschberg или sparse
+//   --threads N     - количество потоков для заполнения матрицы и строк длин (по умолчанию все ядра)
+//   --mmap          - держать матрицу во временном файле, отображенном в память, а не в куче
+//   --bench N M     - замер ускорения волнового фронта на случайных последовательностях, до --threads потоков
+//   --binary        - печатать ответ как int64 в little-endian без разделителей
+auto main(int argc, char** argv) -> int {
+    const std::vector<std::string> args(argv + 1, argv + argc);
+    bool is_length_only = false;
+    solution::Engine engine = solution::Engine::kAuto;
+    solution::MatrixStorage storage = solution::MatrixStorage::kMemory;
+    size_t threads_count = std::max(std::thread::hardware_concurrency(), 1u);
+    std::optional<std::pair<size_t, size_t>> bench_sizes;
+    for (size_t i = 0; i < args.size(); ++i) {
+        if (args[i] == "--length-only") {
+            is_length_only = true;
+        } else if (args[i] == "--mmap") {
+            storage = solution::MatrixStorage::kFile;
+        } else if (args[i] == "--threads" && i + 1 < args.size()) {
+            threads_count = std::max<size_t>(std::stoul(args[++i]), 1);
+        } else if (args[i] == "--engine" && i + 1 < args.size()) {
+            const auto& name = args[++i];
+            if (name == "auto") {
+                engine = solution::Engine::kAuto;
+            } else if (name == "matrix") {
+                engine = solution::Engine::kMatrix;
+            } else if (name == "hirschberg") {
+                engine = solution::Engine::kHirschberg;
+            } else if (name == "sparse") {
+                engine = solution::Engine::kSparse;
+            } else {
+                throw std::invalid_argument("Unknown engine: " + name);
+            }
+        } else if (args[i] == "--binary") {
+            common::getStdout().setFormat(common::OutputWriter::Format::kBinary);
+        } else if (args[i] == "--bench" && i + 2 < args.size()) {
+            bench_sizes.emplace(std::stoul(args[i+1]), std::stoul(args[i+2]));
+            i += 2;
+        } else {
+            throw std::invalid_argument(
+                "Usage: nop_with_response_recovery [--length-only] [--engine NAME] [--threads N] [--mmap] [--binary] [--bench N M]");
+        }
+    }
+
+    if (bench_sizes) {
+        runBenchmark(bench_sizes->first, bench_sizes->second, threads_count);
+        return 0;
+    }
+
     const auto get_sequence = []() {
         const auto len = common::getFromStdin<size_t>();
         return common::getFromStdin<std::vector<std::int64_t>>(len);
@@ -164,11 +708,16 @@ auto main() -> int {
 
     const auto s1 = get_sequence();
     const auto s2 = get_sequence();
-    const auto nop_s = solution::solve(s1, s2);
+    auto& output = common::getStdout();
+    common::ThreadPool pool(threads_count);
+    if (is_length_only) {
+        output.writeNumber(solution::solveLength(s1, s2, &pool)).writeSeparator('\n');
+        return 0;
+    }
+    const auto nop_s = solution::solve(s1, s2, pool, engine, storage);
 
-    std::copy(
-        nop_s.begin(),
-        nop_s.end(),
-        std::ostream_iterator<std::int64_t>(std::cout, " "));
-    std::cout << std::endl;
+    for (const auto value : nop_s) {
+        output.writeNumber(value).writeSeparator(' ');
+    }
+    output.writeSeparator('\n');
 }
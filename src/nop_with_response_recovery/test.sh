@@ -0,0 +1,88 @@
+#!/bin/bash
+# Проверки nop_with_response_recovery на маленьких входах: test.sh ПУТЬ_К_ПРОГРАММЕ
+set -u
+bin=$1
+source "$(dirname "$0")/../common/test.sh"
+
+# checkLcs ИМЯ ВВОД ДЛИНА [АРГУМЕНТЫ...]
+#
+# При равных по длине НОП движки вправе выбрать разные, так что проверяется не сам вывод, а то,
+# что он длины ДЛИНА и является подпоследовательностью обеих последовательностей (вторая и
+# четвертая строки ввода).
+checkLcs() {
+    local name=$1 input=$2 length=$3
+    shift 3
+    local actual status=0
+    actual=$(printf '%s' "$input" | "$bin" "$@" 2>/dev/null) || status=$?
+    if [[ $status -ne 0 ]] || ! awk -v answer="$actual" -v length_="$length" '
+        BEGIN { answer_length = split(answer, sub_, " ") }
+        NR == 2 || NR == 4 {
+            k = 1
+            for (i = 1; i <= NF && k <= answer_length; ++i) {
+                if ($i == sub_[k]) {
+                    k += 1
+                }
+            }
+            if (k <= answer_length) {
+                is_bad = 1
+            }
+        }
+        END { exit is_bad || answer_length != length_ }' <<< "$input"
+    then
+        echo "FAIL $name (exit $status)"
+        echo "  expected: common subsequence of length $length"
+        echo "  actual:   $(printf '%q' "$actual")"
+        failures=$((failures + 1))
+    fi
+}
+
+# sequences N ВЫРАЖЕНИЕ_1 ВЫРАЖЕНИЕ_2 - две последовательности длины N, i-й элемент - значение
+# выражения от i
+sequences() {
+    awk -v n="$1" "BEGIN {
+        print n; for (i = 0; i < n; ++i) printf \"%d \", ($2); print \"\"
+        print n; for (i = 0; i < n; ++i) printf \"%d \", ($3); print \"\"
+    }"
+}
+
+unique=$'3\n1 2 3\n3\n2 3 1\n'
+ties=$'7\n5 -1 4 4 9 2 7\n6\n-1 4 8 9 7 2\n'
+# Четные, а затем нечетные против всех подряд: НОП - все четные и последний нечетный, N/2 + 1
+evens_odds=$(sequences 3000 "i" "i < 1500 ? 2 * i : 2 * (i - 1500) + 1")$'\n'
+for engine in matrix hirschberg sparse auto; do
+    check "unique $engine" "$unique" "2 3 " --engine "$engine"
+    checkLcs "ties $engine" "$ties" 4 --engine "$engine"
+    check "empty $engine" $'0\n\n3\n1 2 3\n' "" --engine "$engine"
+    check "no common $engine" $'2\n1 2\n2\n3 4\n' "" --engine "$engine"
+    checkLcs "evens odds $engine" "$evens_odds" 1501 --engine "$engine"
+done
+
+# Разреженный движок восстанавливает ту же НОП, что и обратный ход полной матрицы
+check "crossing sparse" $'2\n2 0\n2\n0 2\n' "2 " --engine sparse
+check "mmap" "$ties" "$(printf '%s' "$ties" | "$bin" --engine matrix)" --engine matrix --mmap
+
+check "length only" "$ties" "4" --length-only
+check "length only evens odds" "$evens_odds" "1501" --length-only
+
+# 20000 разных символов не помещаются в таблицу масок, так что битово-параллельное ядро собирает
+# маски строк по спискам позиций
+wide=$(sequences 20000 "i" "i < 10000 ? 2 * i : 2 * (i - 10000) + 1")$'\n'
+check "wide length" "$wide" "10001" --length-only
+
+# 3000x3000 - больше порога волнового фронта полной матрицы. Ответ с потоками должен совпадать
+# с однопоточным клетка в клетку.
+dense=$(sequences 3000 "(i * i + 3) % 7" "(i * 5 + i % 11) % 6")$'\n'
+check "dense wavefront" "$dense" "$(printf '%s' "$dense" | "$bin" --threads 1)" --threads 3
+
+# Строки длин Хиршберга и --length-only тоже считаются волновым фронтом, когда строк и слов
+# достаточно много
+dense_length=$(printf '%s' "$dense" | "$bin" --length-only --threads 1)
+check "dense length wavefront" "$dense" "$dense_length" --length-only --threads 3
+check "wide length wavefront" "$wide" "10001" --length-only --threads 3
+for engine in matrix hirschberg; do
+    expected=$(printf '%s' "$dense" | "$bin" --engine "$engine" --threads 1)
+    check "dense $engine wavefront" "$dense" "$expected" --engine "$engine" --threads 3
+    checkLcs "dense $engine" "$dense" "$dense_length" --engine "$engine" --threads 3
+done
+
+finish
@@ -1,97 +1,762 @@
-#include <iostream>
+#include <algorithm>
+#include <array>
+#include <bit>
 #include <cstdint>
 #include <iterator>
+#include <limits>
+#include <numeric>
+#include <optional>
+#include <queue>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <utility>
 #include <vector>
-#include <sstream>
-
-namespace common {
-    template <typename T>
-    concept ReservableEmplacableContainer = requires (T c) {
-        typename T::value_type;
-        c.reserve(size_t{0});
-        c.emplace_back();
-    };
 
-    template <typename Value>
-    auto getFromStdin() -> Value {
-        Value var;
-        std::cin >> var;
-        if (!std::cin.good()) {
-            throw std::runtime_error("Failed to read value from stdin");
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+#include "common/input.h"
+#include "common/matrix.h"
+#include "common/output.h"
+#include "common/thread_pool.h"
+
+namespace solution {
+    using MapValue = std::int64_t;
+    using MapWithPoints = common::Matrix<MapValue>;
+    using Path = std::vector<char>;
+    using PointsSum = std::int64_t;
+
+    // Сумма "пути" в клетку за краем сетки: такого пути нет, поэтому он проигрывает любому
+    // настоящему. Запас от минимума такой, что сумма со значением клетки не переполняется.
+    constexpr MapValue kUnreachableSum = std::numeric_limits<MapValue>::min() / 4;
+
+    // Решения "пришли сверху" по биту на клетку. Каждая строка выровнена по 64-битным словам, так что
+    // строку можно заполнять целыми словами. Storage - где лежат слова: в памяти или в файле.
+    template <typename Storage>
+    class BasicDecisionBits {
+    public:
+        constexpr static size_t kWordBits = 64;
+
+        BasicDecisionBits(const size_t height, const size_t width)
+            : __words(height, (width + kWordBits - 1) / kWordBits)
+        {
         }
-        return var;
-    }
 
-    template <ReservableEmplacableContainer Collection, typename ... Args>
-    auto getFromStdin(const size_t n, Args ... ns) -> Collection {
-        Collection collection;
-        collection.reserve(n);
+        auto getRow(const size_t j) -> std::span<std::uint64_t> {
+            return __words.getRow(j);
+        }
 
-        for (size_t i = 0; i < n; ++i) {
-            collection.emplace_back(
-                getFromStdin<typename Collection::value_type>(ns...));
+        auto isFromUp(const size_t j, const size_t i) const -> bool {
+            return (__words(j, i / kWordBits) >> (i % kWordBits)) & 1;
         }
 
-        return collection;
+    private:
+        common::Matrix<
+            std::uint64_t,
+            common::RowMajorLayout,
+            Storage,
+            common::UncheckedAccess
+        > __words;
+    };
+
+    using DecisionBits = BasicDecisionBits<common::VectorStorage<std::uint64_t>>;
+    using FileDecisionBits = BasicDecisionBits<common::MmapStorage<std::uint64_t>>;
+
+    // Считает суммы строки j поверх сумм предыдущей строки в sums и записывает решения строки в bits
+    auto fillRow(
+        const std::span<const MapValue> values,
+        const size_t j,
+        std::vector<MapValue>& sums,
+        const std::span<std::uint64_t> bits) -> void
+    {
+        const size_t width = sums.size();
+        std::uint64_t word = 0;
+        for (size_t i = 0; i < width; ++i) {
+            // В начальную клетку путь "приходит сверху" с нулевой суммой
+            const MapValue left = i >= 1 ? sums[i-1] : kUnreachableSum;
+            const MapValue up = j >= 1 ? sums[i] : (i == 0 ? 0 : kUnreachableSum);
+            // При равенстве идем слева, как и при обратном ходе
+            const bool is_from_up = up > left;
+            sums[i] = values[i] + (is_from_up ? up : left);
+            word |= std::uint64_t{is_from_up} << (i % DecisionBits::kWordBits);
+            if (i % DecisionBits::kWordBits == DecisionBits::kWordBits - 1 || i + 1 == width) {
+                bits[i / DecisionBits::kWordBits] = word;
+                word = 0;
+            }
+        }
     }
-}  // namespace common
 
-namespace solution {
-    using MapValue = std::int64_t;
-    using MapWithPoints = std::vector<std::vector<MapValue>>;
-    using Path = std::vector<char>;
-    using PointsSum = std::uint64_t;
+    // Мы будем использовать метод мемоизации в нашем решении.
+    //
+    // Для каждой клетки посчитаем максимально возможную сумму очков, с которой можно прийти в
+    // эту клетку: так как двигаться мы можем только вниз и вправо, это значение клетки плюс
+    // максимум из сумм верхней и левой клеток (за край сетки пути нет, см. kUnreachableSum).
+    //
+    // Все суммы хранить не нужно: достаточно одной строки, в которой слева от текущей клетки уже
+    // лежат суммы текущей строки, а начиная с нее - еще суммы предыдущей. Для обратного хода
+    // запоминаем только, пришли ли в клетку сверху, по биту на клетку. Возвращает сумму в правом
+    // нижнем углу.
+    auto fillByRows(const MapWithPoints& map, DecisionBits& decisions) -> PointsSum {
+        const auto height = map.getHeight();
+        const auto width = map.getWidth();
+        std::vector<MapValue> sums(width);
+        for (size_t j = 0; j < height; ++j) {
+            fillRow(map.getRow(j), j, sums, decisions.getRow(j));
+        }
+        return sums[width-1];
+    }
 
-    auto solve(MapWithPoints map) -> std::tuple<PointsSum, Path> {
-        const auto height = map.size();
-        const auto width = (height == 0) ? 0
-                                         : map[0].size();
+    // Прямоугольный кусок сетки [row_begin, row_end) x [column_begin, column_end) для волнового
+    // фронта. Суммы на границах плитки передаются через две общие полосы: row_sums - суммы
+    // последней посчитанной строки по всей ширине сетки, column_sums - суммы последнего посчитанного
+    // столбца по всей высоте. Плитка читает из них суммы над собой и слева от себя и записывает на их
+    // место свою нижнюю строку и правый столбец. Плитки одного фронта не пересекаются ни по строкам,
+    // ни по столбцам, так что полосы можно делить без синхронизации. В начале полосы заполнены
+    // kUnreachableSum, кроме нуля над начальной клеткой, - так за краем сетки все как и в построчном
+    // проходе.
+    struct Tile {
+        const MapWithPoints* map;
+        DecisionBits* decisions;
+        MapValue* row_sums;
+        MapValue* column_sums;
+        size_t row_begin;
+        size_t row_end;
+        size_t column_begin;
+        size_t column_end;
+    };
 
-        // Мы будем использовать метод мемоизации в нашем решении.
-        //
-        // Рассчитаем матрицу, каждая клетка которой будет содержать
-        // максимально возможную сумму очков с которой можно прийти в
-        // эту клетку.
+    namespace tile_kernels {
+        using Kernel = void (*)(const Tile& tile);
+
+        // Построчный проход по строкам [row_begin, row_end) плитки. Плитки начинаются с границы
+        // слова, так что слова решений целиком принадлежат одной плитке.
+        inline auto scalarRows(const Tile& tile, const size_t row_begin, const size_t row_end) -> void {
+            for (size_t j = row_begin; j < row_end; ++j) {
+                const MapValue* values = tile.map->getRow(j).data();
+                std::uint64_t* bits = tile.decisions->getRow(j).data();
+                MapValue left = tile.column_sums[j];
+                std::uint64_t word = 0;
+                for (size_t i = tile.column_begin; i < tile.column_end; ++i) {
+                    const MapValue up = tile.row_sums[i];
+                    const bool is_from_up = up > left;
+                    left = values[i] + (is_from_up ? up : left);
+                    tile.row_sums[i] = left;
+                    word |= std::uint64_t{is_from_up} << (i % DecisionBits::kWordBits);
+                    if (i % DecisionBits::kWordBits == DecisionBits::kWordBits - 1 || i + 1 == tile.column_end) {
+                        bits[i / DecisionBits::kWordBits] = word;
+                        word = 0;
+                    }
+                }
+                tile.column_sums[j] = left;
+            }
+        }
+
+        inline auto scalar(const Tile& tile) -> void {
+            scalarRows(tile, tile.row_begin, tile.row_end);
+        }
+
+        // Векторные ядра считают полосу из kLanes строк со сдвигом: на шаге t дорожка r считает
+        // клетку (row + r, column_begin + t - r), то есть все дорожки идут по одной антидиагонали.
+        // Тогда левая сумма дорожки - ее же значение с прошлого шага, а верхняя - значение соседней
+        // дорожки с прошлого шага, сдвинутое на одну дорожку; нулевая дорожка берет верхнюю сумму
+        // из row_sums. Значения клеток собираются по дорожкам через gather. Дорожки вне плитки (в
+        // начале и в конце полосы) не обновляются.
         //
-        // Так как двигаться мы можем только в направлении вниз и вправо,
-        // то что бы найти такие суммы, мы должны выбрать максимальное значение
-        // из верхней или левой клетки и прибавить к текущему, при учете того,
-        // что значения для этих клеток уже просчитаны
-        for (size_t j = 0; j < height; ++j) {
-            for (size_t i = 0; i < width; ++i) {
-                map[j][i] += std::max(
-                    i >= 1 ? map[j][i-1] : 0,
-                    j >= 1 ? map[j-1][i] : 0);
+        // Суммы последней дорожки отстают от нулевой на kLanes-1 шагов, так что их можно сразу
+        // писать в row_sums на место уже прочитанных. Решения шагов [64k, 64k + 64) каждая дорожка
+        // копит в своем 64-битном слове, которое потом сохраняется в words[k * kLanes + r]; из-за
+        // сдвига слово дорожки r начинается на r столбцов раньше, это выправляется при записи в таблицу.
+        template <size_t kLanes>
+        auto getWordsCount(const Tile& tile) -> size_t {
+            const size_t steps = tile.column_end - tile.column_begin + kLanes - 1;
+            return ((steps + DecisionBits::kWordBits - 1) / DecisionBits::kWordBits + 1) * kLanes;
+        }
+
+        template <size_t kLanes>
+        auto storeDecisionWords(const Tile& tile, const size_t row, const std::vector<std::uint64_t>& words) -> void {
+            const size_t columns = tile.column_end - tile.column_begin;
+            const size_t words_count = (columns + DecisionBits::kWordBits - 1) / DecisionBits::kWordBits;
+            // Решения неактивных дорожек в конце полосы - мусор, в таблице там должны быть нули
+            const size_t tail_bits = columns % DecisionBits::kWordBits;
+            const std::uint64_t last_word_mask = tail_bits == 0 ? ~std::uint64_t{0} : (std::uint64_t{1} << tail_bits) - 1;
+            for (size_t r = 0; r < kLanes; ++r) {
+                std::uint64_t* bits = tile.decisions->getRow(row + r).data() + tile.column_begin / DecisionBits::kWordBits;
+                for (size_t m = 0; m < words_count; ++m) {
+                    std::uint64_t word = words[m * kLanes + r] >> r;
+                    if (r != 0) {
+                        word |= words[(m + 1) * kLanes + r] << (DecisionBits::kWordBits - r);
+                    }
+                    bits[m] = m + 1 == words_count ? word & last_word_mask : word;
+                }
+            }
+        }
+
+        // Смещения значений дорожек относительно начала плитки в строке row на нулевом шаге
+        template <size_t kLanes>
+        auto getLaneOffsets(const Tile& tile, const size_t row) -> std::array<long long, kLanes> {
+            const MapValue* values = tile.map->getRow(row).data();
+            std::array<long long, kLanes> offsets;
+            for (size_t r = 0; r < kLanes; ++r) {
+                offsets[r] = tile.map->getRow(row + r).data() - values - static_cast<long long>(r);
             }
+            return offsets;
         }
 
-        // Теперь когда у нас есть карта с максимальными значениями маршрута до
-        // каждой клетки, то что-бы найти самый эффективный путь, мы должны
-        // обойти матрицу начиная с конечной точки до начальной точки, выбирая
-        // те клетки, значения суммы в которых максимально.
+#if defined(__x86_64__) || defined(__i386__)
+        // В AVX2 помещается только 4 суммы, поэтому полоса из 8 дорожек держится в двух регистрах:
+        // так две цепочки зависимостей шага идут параллельно
+        __attribute__((target("avx2")))
+        inline auto avx2(const Tile& tile) -> void {
+            constexpr size_t kLanes = 8;
+            constexpr size_t kHalf = 4;
+            const size_t columns = tile.column_end - tile.column_begin;
+            const size_t steps = columns + kLanes - 1;
+            std::vector<std::uint64_t> words(getWordsCount<kLanes>(tile));
+            const __m256i zero = _mm256_setzero_si256();
+            const __m256i one = _mm256_set1_epi64x(1);
+            const __m256i columns_v = _mm256_set1_epi64x(static_cast<long long>(columns));
+
+            size_t row = tile.row_begin;
+            for (; row + kLanes <= tile.row_end; row += kLanes) {
+                const MapValue* values = tile.map->getRow(row).data() + tile.column_begin;
+                const auto offsets = getLaneOffsets<kLanes>(tile, row);
+                __m256i offsets_lo = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(offsets.data()));
+                __m256i offsets_hi = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(offsets.data() + kHalf));
+                // Столбец клетки дорожки относительно начала плитки
+                __m256i column_lo = _mm256_set_epi64x(-3, -2, -1, 0);
+                __m256i column_hi = _mm256_set_epi64x(-7, -6, -5, -4);
+                __m256i sums_lo = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(tile.column_sums + row));
+                __m256i sums_hi = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(tile.column_sums + row + kHalf));
+                __m256i word_lo = zero;
+                __m256i word_hi = zero;
+                std::fill(words.begin(), words.end(), 0);
+
+                for (size_t t = 0; t < steps; ++t) {
+                    const MapValue top = t < columns ? tile.row_sums[tile.column_begin + t] : 0;
+                    const __m256i up_lo = _mm256_blend_epi32(
+                        _mm256_permute4x64_epi64(sums_lo, _MM_SHUFFLE(2, 1, 0, 0)),
+                        _mm256_set1_epi64x(top),
+                        0b00000011);
+                    const __m256i up_hi = _mm256_blend_epi32(
+                        _mm256_permute4x64_epi64(sums_hi, _MM_SHUFFLE(2, 1, 0, 0)),
+                        _mm256_permute4x64_epi64(sums_lo, _MM_SHUFFLE(3, 3, 3, 3)),
+                        0b00000011);
+
+                    // Активны дорожки, для которых 0 <= t - r < columns
+                    const __m256i is_active_lo = _mm256_andnot_si256(
+                        _mm256_cmpgt_epi64(zero, column_lo), _mm256_cmpgt_epi64(columns_v, column_lo));
+                    const __m256i is_active_hi = _mm256_andnot_si256(
+                        _mm256_cmpgt_epi64(zero, column_hi), _mm256_cmpgt_epi64(columns_v, column_hi));
+                    const __m256i cells_lo = _mm256_mask_i64gather_epi64(
+                        zero, reinterpret_cast<const long long*>(values), offsets_lo, is_active_lo, sizeof(MapValue));
+                    const __m256i cells_hi = _mm256_mask_i64gather_epi64(
+                        zero, reinterpret_cast<const long long*>(values), offsets_hi, is_active_hi, sizeof(MapValue));
+
+                    const __m256i is_from_up_lo = _mm256_cmpgt_epi64(up_lo, sums_lo);
+                    const __m256i is_from_up_hi = _mm256_cmpgt_epi64(up_hi, sums_hi);
+                    const __m256i next_lo = _mm256_add_epi64(cells_lo, _mm256_blendv_epi8(sums_lo, up_lo, is_from_up_lo));
+                    const __m256i next_hi = _mm256_add_epi64(cells_hi, _mm256_blendv_epi8(sums_hi, up_hi, is_from_up_hi));
+                    sums_lo = _mm256_blendv_epi8(sums_lo, next_lo, is_active_lo);
+                    sums_hi = _mm256_blendv_epi8(sums_hi, next_hi, is_active_hi);
+
+                    const __m256i bit = _mm256_set1_epi64x(static_cast<long long>(
+                        std::uint64_t{1} << (t % DecisionBits::kWordBits)));
+                    word_lo = _mm256_or_si256(word_lo, _mm256_and_si256(is_from_up_lo, bit));
+                    word_hi = _mm256_or_si256(word_hi, _mm256_and_si256(is_from_up_hi, bit));
+                    if (t % DecisionBits::kWordBits == DecisionBits::kWordBits - 1 || t + 1 == steps) {
+                        auto* block = words.data() + t / DecisionBits::kWordBits * kLanes;
+                        _mm256_storeu_si256(reinterpret_cast<__m256i*>(block), word_lo);
+                        _mm256_storeu_si256(reinterpret_cast<__m256i*>(block + kHalf), word_hi);
+                        word_lo = zero;
+                        word_hi = zero;
+                    }
+                    if (t + 1 >= kLanes) {
+                        tile.row_sums[tile.column_begin + t + 1 - kLanes] = _mm256_extract_epi64(sums_hi, 3);
+                    }
+
+                    offsets_lo = _mm256_add_epi64(offsets_lo, one);
+                    offsets_hi = _mm256_add_epi64(offsets_hi, one);
+                    column_lo = _mm256_add_epi64(column_lo, one);
+                    column_hi = _mm256_add_epi64(column_hi, one);
+                }
+
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(tile.column_sums + row), sums_lo);
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(tile.column_sums + row + kHalf), sums_hi);
+                storeDecisionWords<kLanes>(tile, row, words);
+            }
+            scalarRows(tile, row, tile.row_end);
+        }
+
+        __attribute__((target("avx512f")))
+        inline auto avx512(const Tile& tile) -> void {
+            constexpr size_t kLanes = 8;
+            const size_t columns = tile.column_end - tile.column_begin;
+            const size_t steps = columns + kLanes - 1;
+            std::vector<std::uint64_t> words(getWordsCount<kLanes>(tile));
+            const __m512i zero = _mm512_setzero_si512();
+            const __m512i one = _mm512_set1_epi64(1);
+            const __m512i shift = _mm512_set_epi64(6, 5, 4, 3, 2, 1, 0, 0);
+
+            size_t row = tile.row_begin;
+            for (; row + kLanes <= tile.row_end; row += kLanes) {
+                const MapValue* values = tile.map->getRow(row).data() + tile.column_begin;
+                __m512i offsets = _mm512_loadu_si512(getLaneOffsets<kLanes>(tile, row).data());
+                __m512i sums = _mm512_loadu_si512(tile.column_sums + row);
+                __m512i word = zero;
+                std::fill(words.begin(), words.end(), 0);
+
+                for (size_t t = 0; t < steps; ++t) {
+                    // Активны дорожки r, для которых 0 <= t - r < columns
+                    const size_t first_lane = t >= columns ? t - columns + 1 : 0;
+                    const size_t last_lane = std::min(t, kLanes - 1);
+                    const __mmask8 is_active = static_cast<__mmask8>(
+                        ((2u << last_lane) - 1) & ~((1u << first_lane) - 1));
+
+                    const MapValue top = t < columns ? tile.row_sums[tile.column_begin + t] : 0;
+                    const __m512i up = _mm512_mask_permutexvar_epi64(_mm512_set1_epi64(top), 0xFE, shift, sums);
+                    const __m512i cells = _mm512_mask_i64gather_epi64(zero, is_active, offsets, values, sizeof(MapValue));
+                    const __mmask8 is_from_up = _mm512_mask_cmpgt_epi64_mask(is_active, up, sums);
+                    const __m512i best = _mm512_mask_max_epi64(sums, is_active, up, sums);
+                    sums = _mm512_mask_add_epi64(sums, is_active, cells, best);
+
+                    const __m512i bit = _mm512_set1_epi64(static_cast<long long>(
+                        std::uint64_t{1} << (t % DecisionBits::kWordBits)));
+                    word = _mm512_mask_or_epi64(word, is_from_up, word, bit);
+                    if (t % DecisionBits::kWordBits == DecisionBits::kWordBits - 1 || t + 1 == steps) {
+                        _mm512_storeu_si512(words.data() + t / DecisionBits::kWordBits * kLanes, word);
+                        word = zero;
+                    }
+                    if (t + 1 >= kLanes) {
+                        const __m128i last = _mm512_mask_extracti32x4_epi32(_mm_setzero_si128(), 0xF, sums, 3);
+                        tile.row_sums[tile.column_begin + t + 1 - kLanes] = _mm_extract_epi64(last, 1);
+                    }
+                    offsets = _mm512_add_epi64(offsets, one);
+                }
+
+                _mm512_storeu_si512(tile.column_sums + row, sums);
+                storeDecisionWords<kLanes>(tile, row, words);
+            }
+            scalarRows(tile, row, tile.row_end);
+        }
+#endif
+
+        inline auto select() -> Kernel {
+#if defined(__x86_64__) || defined(__i386__)
+            __builtin_cpu_init();
+            if (__builtin_cpu_supports("avx512f")) {
+                return avx512;
+            }
+            if (__builtin_cpu_supports("avx2")) {
+                return avx2;
+            }
+#endif
+            return scalar;
+        }
+    }  // namespace tile_kernels
+
+    // Плитки сетки считаются волновым фронтом: плитке (r, c) нужны только плитки (r-1, c) и
+    // (r, c-1), так что все плитки с одинаковым r + c можно считать одновременно. Ширина плитки
+    // кратна слову решений, а размеры подобраны так, что значения плитки и буферы ядра помещаются
+    // в L2.
+    constexpr size_t kTileRows = 256;
+    constexpr size_t kTileColumns = 1024;
+
+    auto fillByWavefront(const MapWithPoints& map, DecisionBits& decisions, common::ThreadPool& pool) -> PointsSum {
+        static_assert(kTileColumns % DecisionBits::kWordBits == 0);
+        const auto height = map.getHeight();
+        const auto width = map.getWidth();
+        const size_t tile_rows = (height + kTileRows - 1) / kTileRows;
+        const size_t tile_columns = (width + kTileColumns - 1) / kTileColumns;
+        const tile_kernels::Kernel kernel = tile_kernels::select();
+
+        std::vector<MapValue> row_sums(width, kUnreachableSum);
+        std::vector<MapValue> column_sums(height, kUnreachableSum);
+        row_sums[0] = 0;
+        for (size_t front = 0; front + 1 < tile_rows + tile_columns; ++front) {
+            const size_t first_row = front >= tile_columns ? front - tile_columns + 1 : 0;
+            const size_t last_row = std::min(front, tile_rows - 1);
+            pool.run(last_row - first_row + 1, [&](const size_t k) {
+                const size_t r = first_row + k;
+                const size_t c = front - r;
+                kernel(Tile{
+                    .map = &map,
+                    .decisions = &decisions,
+                    .row_sums = row_sums.data(),
+                    .column_sums = column_sums.data(),
+                    .row_begin = r * kTileRows,
+                    .row_end = std::min(height, (r + 1) * kTileRows),
+                    .column_begin = c * kTileColumns,
+                    .column_end = std::min(width, (c + 1) * kTileColumns),
+                });
+            });
+        }
+        return row_sums[width-1];
+    }
+
+    // Теперь, чтобы найти самый эффективный путь, обходим матрицу от конечной точки до начальной
+    // по запомненным решениям. На верхней строке и левом столбце путь может идти только вдоль края.
+    //
+    // Надо учитывать что тут маршрут находится в перевернутом представлении
+    template <typename Decisions>
+    auto restorePath(const Decisions& decisions, const size_t height, const size_t width) -> Path {
         size_t i = width-1;
         size_t j = height-1;
-        PointsSum points_sum = map[j][i];
         Path path;
+        path.reserve(height + width - 2);
         while (j != 0 || i != 0) {
-            MapValue up_points = (j != 0) ? map[j-1][i] : -1;
-            MapValue left_points = (i != 0) ? map[j][i-1] : -1;
-            
-            auto& direction = path.emplace_back();
-            if (up_points > left_points) {
-                direction = 'D';
+            if (i == 0 || (j != 0 && decisions.isFromUp(j, i))) {
+                path.emplace_back('D');
                 --j;
             } else {
-                direction = 'R';
+                path.emplace_back('R');
                 --i;
             }
         }
+        return path;
+    }
+
+    // Без пула потоков сетка считается построчно, с пулом - волновым фронтом по плиткам. Суммы и
+    // решения у обоих способов совпадают.
+    auto solve(const MapWithPoints& map, common::ThreadPool* pool = nullptr) -> std::tuple<PointsSum, Path> {
+        const auto height = map.getHeight();
+        const auto width = map.getWidth();
+        if (height == 0 || width == 0) {
+            return std::make_tuple(PointsSum{0}, Path{});
+        }
+
+        DecisionBits decisions(height, width);
+        const PointsSum points_sum = pool == nullptr
+            ? fillByRows(map, decisions)
+            : fillByWavefront(map, decisions, *pool);
+        return std::make_tuple(points_sum, restorePath(decisions, height, width));
+    }
+
+    using SumsTable = common::Matrix<
+        MapValue,
+        common::RowMajorLayout,
+        common::VectorStorage<MapValue>,
+        common::UncheckedAccess
+    >;
 
-        // Надо учитывать что тут маршрут находится в перевернутом представлении
-        return std::make_tuple(points_sum, path);
+    // Таблица лучших продолжений: наибольшая сумма пути из клетки в правый нижний угол, включая
+    // саму клетку. В отличие от прямого прохода, здесь у клетки на краю есть ровно один ход.
+    auto getBestToEnd(const MapWithPoints& map) -> SumsTable {
+        const auto height = map.getHeight();
+        const auto width = map.getWidth();
+        SumsTable best(height, width);
+        for (size_t j = height; j-- > 0;) {
+            for (size_t i = width; i-- > 0;) {
+                if (j + 1 == height && i + 1 == width) {
+                    best(j, i) = map(j, i);
+                } else if (j + 1 == height) {
+                    best(j, i) = map(j, i) + best(j, i+1);
+                } else if (i + 1 == width) {
+                    best(j, i) = map(j, i) + best(j+1, i);
+                } else {
+                    best(j, i) = map(j, i) + std::max(best(j+1, i), best(j, i+1));
+                }
+            }
+        }
+        return best;
     }
+
+    // Перебор routes_count лучших различных маршрутов в порядке невозрастания сумм.
+    //
+    // Каждый маршрут, кроме лучшего, получается из уже найденного маршрута-родителя отклонением: до
+    // клетки отклонения он совпадает с родителем, в ней делает другой ход, а дальше идет по лучшим
+    // продолжениям. Отклонения берутся только на хвосте родителя после его собственного отклонения,
+    // так что каждый маршрут получается ровно одним способом. Сумма отклонения - сумма родителя минус
+    // разница лучших продолжений двух ходов, поэтому в куче лежат только отклонения с суммами, а сам
+    // маршрут восстанавливается лениво, когда отклонение достается из кучи.
+    auto solveTopRoutes(const MapWithPoints& map, const size_t routes_count) -> std::vector<std::tuple<PointsSum, Path>> {
+        const auto height = map.getHeight();
+        const auto width = map.getWidth();
+        std::vector<std::tuple<PointsSum, Path>> result;
+        if (height == 0 || width == 0) {
+            return result;
+        }
+        const SumsTable best = getBestToEnd(map);
+
+        constexpr size_t kNoParent = std::numeric_limits<size_t>::max();
+        struct Deviation {
+            size_t parent;
+            size_t row;
+            size_t column;
+        };
+        struct Candidate {
+            MapValue sum;
+            Deviation deviation;
+
+            auto operator<(const Candidate& other) const -> bool {
+                return sum < other.sum;
+            }
+        };
+
+        std::vector<Deviation> routes;
+        std::priority_queue<Candidate> candidates;
+        candidates.push(Candidate{best(0, 0), Deviation{kNoParent, 0, 0}});
+        std::vector<std::pair<size_t, size_t>> turns;
+        while (!candidates.empty() && result.size() < routes_count) {
+            const Candidate candidate = candidates.top();
+            candidates.pop();
+            const size_t id = routes.size();
+            routes.push_back(candidate.deviation);
+
+            turns.clear();
+            for (size_t route = id; routes[route].parent != kNoParent; route = routes[route].parent) {
+                turns.emplace_back(routes[route].row, routes[route].column);
+            }
+            std::reverse(turns.begin(), turns.end());
+
+            // Идем из начала по лучшим продолжениям, сворачивая в клетках отклонений. На хвосте
+            // после последнего отклонения заодно кладем в кучу отклонения нового маршрута.
+            Path path;
+            path.reserve(height + width - 2);
+            size_t next_turn = 0;
+            size_t j = 0;
+            size_t i = 0;
+            while (j + 1 != height || i + 1 != width) {
+                bool is_down = i + 1 == width;
+                if (j + 1 != height && i + 1 != width) {
+                    const MapValue down = best(j+1, i);
+                    const MapValue right = best(j, i+1);
+                    // Лучший ход - вниз, только если продолжение снизу строго лучше
+                    is_down = down > right;
+                    if (next_turn < turns.size() && turns[next_turn] == std::make_pair(j, i)) {
+                        is_down = !is_down;
+                        next_turn += 1;
+                    } else if (next_turn == turns.size()) {
+                        const MapValue loss = is_down ? down - right : right - down;
+                        candidates.push(Candidate{candidate.sum - loss, Deviation{id, j, i}});
+                    }
+                }
+                if (is_down) {
+                    path.emplace_back('D');
+                    ++j;
+                } else {
+                    path.emplace_back('R');
+                    ++i;
+                }
+            }
+
+            // Как и в solve, маршрут отдается в перевернутом представлении
+            std::reverse(path.begin(), path.end());
+            result.emplace_back(PointsSum(candidate.sum), std::move(path));
+        }
+        return result;
+    }
+
+    // Запрос лучшей суммы пути из клетки (row_from, column_from) в клетку (row_to, column_to)
+    struct RectangleQuery {
+        size_t row_from;
+        size_t column_from;
+        size_t row_to;
+        size_t column_to;
+    };
+
+    // Лучшая сумма одного запроса одним проходом по его прямоугольнику, за O(его площади)
+    auto solveRectangleQuery(const MapWithPoints& map, const RectangleQuery& query) -> MapValue {
+        const size_t width = query.column_to - query.column_from + 1;
+        std::vector<MapValue> sums(width);
+        for (size_t j = query.row_from; j <= query.row_to; ++j) {
+            for (size_t x = 0; x < width; ++x) {
+                MapValue best = 0;
+                if (j == query.row_from) {
+                    best = x == 0 ? 0 : sums[x-1];
+                } else {
+                    best = x == 0 ? sums[x] : std::max(sums[x], sums[x-1]);
+                }
+                sums[x] = map(j, query.column_from + x) + best;
+            }
+        }
+        return sums[width-1];
+    }
+
+    // Отвечает на пачку запросов сразу, деля строки пополам. Каждый путь запроса, у которого
+    // row_from <= mid <= row_to, пересекает строку mid в каком-то столбце c из [column_from,
+    // column_to], поэтому для каждого такого c достаточно посчитать лучшие суммы от всех клеток
+    // выше до (mid, c) и от (mid, c) до всех клеток ниже - и ответить всем запросам отрезка сразу.
+    // Остальные запросы целиком лежат выше или ниже mid и уходят в половины. Всего выходит
+    // O(N * M^2 * log N + Q * M) независимо от размеров запросов.
+    auto solveRectangleQueriesByHalving(
+        const MapWithPoints& map,
+        const std::vector<RectangleQuery>& queries) -> std::vector<PointsSum>
+    {
+        const auto height = map.getHeight();
+        const auto width = map.getWidth();
+
+        struct Segment {
+            size_t row_begin;
+            size_t row_end;
+            size_t queries_begin;
+            size_t queries_end;
+        };
+
+        std::vector<MapValue> answers(queries.size(), std::numeric_limits<MapValue>::min());
+        std::vector<size_t> order(queries.size());
+        std::iota(order.begin(), order.end(), 0);
+        std::vector<Segment> segments{Segment{0, height, 0, order.size()}};
+        while (!segments.empty()) {
+            const Segment segment = segments.back();
+            segments.pop_back();
+            if (segment.queries_begin == segment.queries_end) {
+                continue;
+            }
+
+            const size_t mid = (segment.row_begin + segment.row_end) / 2;
+            const auto first = order.begin() + segment.queries_begin;
+            const auto last = order.begin() + segment.queries_end;
+            const auto above_end = std::partition(first, last, [&](const size_t q) { return queries[q].row_to < mid; });
+            const auto below_end = std::partition(above_end, last, [&](const size_t q) { return queries[q].row_from > mid; });
+            const size_t above_count = static_cast<size_t>(above_end - first);
+            const size_t below_count = static_cast<size_t>(below_end - above_end);
+            segments.push_back(Segment{
+                segment.row_begin, mid, segment.queries_begin, segment.queries_begin + above_count});
+            segments.push_back(Segment{
+                mid + 1, segment.row_end, segment.queries_begin + above_count, segment.queries_begin + above_count + below_count});
+
+            const std::span<const size_t> crossing(below_end, last);
+            if (crossing.empty()) {
+                continue;
+            }
+            size_t top = mid;
+            size_t bottom = mid;
+            size_t left = width;
+            size_t right = 0;
+            for (const size_t q : crossing) {
+                top = std::min(top, queries[q].row_from);
+                bottom = std::max(bottom, queries[q].row_to);
+                left = std::min(left, queries[q].column_from);
+                right = std::max(right, queries[q].column_to);
+            }
+
+            // to_mid(r - top, x - left) - лучшая сумма от (r, x) до (mid, c), from_mid(r - mid, x - left)
+            // - от (mid, c) до (r, x); обе включают (mid, c)
+            SumsTable to_mid(mid - top + 1, right - left + 1);
+            SumsTable from_mid(bottom - mid + 1, right - left + 1);
+            for (size_t c = left; c <= right; ++c) {
+                const size_t k = c - left;
+                to_mid(mid - top, k) = map(mid, c);
+                for (size_t x = k; x-- > 0;) {
+                    to_mid(mid - top, x) = map(mid, left + x) + to_mid(mid - top, x+1);
+                }
+                for (size_t r = mid - top; r-- > 0;) {
+                    to_mid(r, k) = map(top + r, c) + to_mid(r+1, k);
+                    for (size_t x = k; x-- > 0;) {
+                        to_mid(r, x) = map(top + r, left + x) + std::max(to_mid(r+1, x), to_mid(r, x+1));
+                    }
+                }
+
+                from_mid(0, k) = map(mid, c);
+                for (size_t x = k + 1; x <= right - left; ++x) {
+                    from_mid(0, x) = from_mid(0, x-1) + map(mid, left + x);
+                }
+                for (size_t r = 1; r <= bottom - mid; ++r) {
+                    from_mid(r, k) = from_mid(r-1, k) + map(mid + r, c);
+                    for (size_t x = k + 1; x <= right - left; ++x) {
+                        from_mid(r, x) = map(mid + r, left + x) + std::max(from_mid(r-1, x), from_mid(r, x-1));
+                    }
+                }
+
+                for (const size_t q : crossing) {
+                    const auto& query = queries[q];
+                    if (query.column_from <= c && c <= query.column_to) {
+                        const MapValue sum = to_mid(query.row_from - top, query.column_from - left)
+                            + from_mid(query.row_to - mid, query.column_to - left)
+                            - map(mid, c);
+                        answers[q] = std::max(answers[q], sum);
+                    }
+                }
+            }
+        }
+        return std::vector<PointsSum>(answers.begin(), answers.end());
+    }
+
+    // Деление пополам окупается только на множестве больших запросов: его подготовка стоит около
+    // N * M^2 * log N даже для одного запроса. Поэтому сначала оцениваем обе стоимости и, если
+    // суммарная площадь запросов меньше, отвечаем на каждый запрос отдельным проходом.
+    auto solveRectangleQueries(const MapWithPoints& map, const std::vector<RectangleQuery>& queries) -> std::vector<PointsSum> {
+        const auto height = map.getHeight();
+        const auto width = map.getWidth();
+        double areas_sum = 0;
+        for (const auto& query : queries) {
+            if (query.row_from > query.row_to || query.column_from > query.column_to
+                || query.row_to >= height || query.column_to >= width)
+            {
+                throw std::out_of_range("query is out of the grid");
+            }
+            areas_sum += static_cast<double>(query.row_to - query.row_from + 1)
+                * static_cast<double>(query.column_to - query.column_from + 1);
+        }
+
+        const double halving_cost = static_cast<double>(height) * static_cast<double>(width)
+            * static_cast<double>(width) * std::bit_width(height);
+        if (areas_sum > halving_cost) {
+            return solveRectangleQueriesByHalving(map, queries);
+        }
+        std::vector<PointsSum> answers;
+        answers.reserve(queries.size());
+        for (const auto& query : queries) {
+            answers.emplace_back(solveRectangleQuery(map, query));
+        }
+        return answers;
+    }
+
+    // Потоковый решатель для сеток, которые не помещаются в память: строки подаются по одной через
+    // push(), а в памяти живет только строка сумм. Решения по биту на клетку пишутся в файл
+    // (common::MmapStorage), страницы которого ядро сбрасывает на диск и вытесняет по мере
+    // надобности, так что и заполнение, и обратный ход идут с ограниченной памятью: обратный ход
+    // читает файл один раз, от конца к началу.
+    class StreamingSolver {
+    public:
+        StreamingSolver(const size_t height, const size_t width)
+            : __sums(width, 0)
+            , __decisions(height, width)
+            , __height(height)
+        {
+        }
+
+        auto push(const std::span<const MapValue> values) -> void {
+            if (__rows_count == __height || values.size() != __sums.size()) {
+                throw std::out_of_range("row does not fit the grid");
+            }
+            fillRow(values, __rows_count, __sums, __decisions.getRow(__rows_count));
+            __rows_count += 1;
+        }
+
+        auto getResult() const -> std::tuple<PointsSum, Path> {
+            const size_t width = __sums.size();
+            if (__height == 0 || width == 0) {
+                return std::make_tuple(PointsSum{0}, Path{});
+            }
+            if (__rows_count != __height) {
+                throw std::logic_error("not all rows of the grid were pushed");
+            }
+            return std::make_tuple(PointsSum(__sums[width-1]), restorePath(__decisions, __height, width));
+        }
+
+    private:
+        std::vector<MapValue> __sums;
+        FileDecisionBits __decisions;
+        size_t __height;
+        size_t __rows_count = 0;
+    };
 }  // namespace solution
 
+// В двоичном формате сумма пишется 8 байтами, а за ней маршрут из h+w-2 букв без пробелов
+auto printResult(const solution::PointsSum points_sum, const solution::Path& path) -> void {
+    auto& output = common::getStdout();
+    output.writeNumber(points_sum).writeSeparator('\n');
+    for (auto it = path.rbegin(); it != path.rend(); ++it) {
+        output.writeChar(*it).writeSeparator(' ');
+    }
+    output.writeSeparator('\n');
+}
+
 // https://coderun.yandex.ru/problem/print-the-route-of-the-maximum-cost
 //
 // Условия задачи:
@@ -115,15 +780,99 @@ namespace solution {
 // Пример вывода:
 //  > 74
 //  > D D R R R R D D
+//
+// Флаги:
+// Режимы --wavefront, --stream, --top и --queries взаимоисключающие.
+//
+//   --wavefront - считать сетку волновым фронтом по плиткам в несколько потоков
+//   --threads N - количество потоков для --wavefront (по умолчанию все ядра)
+//   --stream    - читать сетку по строке, не храня ее в памяти; решения держатся во временном
+//                 файле в TMPDIR (или /tmp), по биту на клетку
+//   --top K     - вывести K лучших различных маршрутов (сумма и маршрут для каждого), по убыванию сумм
+//   --queries   - после сетки прочитать Q и Q запросов "r1 c1 r2 c2" (с единицы) и для каждого
+//                 вывести лучшую сумму пути из клетки (r1, c1) в клетку (r2, c2); немного запросов
+//                 считаются каждый своим проходом, много больших - делением строк пополам
+//   --binary    - печатать числа как int64 в little-endian без разделителей
+auto main(int argc, char** argv) -> int {
+    const std::vector<std::string> args(argv + 1, argv + argc);
+    bool is_wavefront = false;
+    bool is_streaming = false;
+    bool is_answering_queries = false;
+    size_t top_routes_count = 0;
+    size_t threads_count = std::max(std::thread::hardware_concurrency(), 1u);
+    const std::string usage =
+        "Usage: print_the_route_of_the_maximum_cost [--wavefront [--threads N] | --stream | --top K | --queries] [--binary]";
+    for (size_t i = 0; i < args.size(); ++i) {
+        if (args[i] == "--wavefront") {
+            is_wavefront = true;
+        } else if (args[i] == "--threads" && i + 1 < args.size()) {
+            threads_count = std::max<size_t>(std::stoul(args[++i]), 1);
+        } else if (args[i] == "--stream") {
+            is_streaming = true;
+        } else if (args[i] == "--top" && i + 1 < args.size()) {
+            top_routes_count = std::stoul(args[++i]);
+        } else if (args[i] == "--queries") {
+            is_answering_queries = true;
+        } else if (args[i] == "--binary") {
+            common::getStdout().setFormat(common::OutputWriter::Format::kBinary);
+        } else {
+            throw std::invalid_argument(usage);
+        }
+    }
+    // Каждый режим считает свое, так что молча выбрать один из нескольких значит ответить не на тот вопрос
+    if (is_wavefront + is_streaming + is_answering_queries + (top_routes_count != 0) > 1) {
+        throw std::invalid_argument(usage);
+    }
 
-auto main() -> int {
     const auto height = common::getFromStdin<std::uint64_t>();
     const auto width = common::getFromStdin<std::uint64_t>();
 
-    auto [points_sum, path] = solution::solve(
-        common::getFromStdin<solution::MapWithPoints>(height, width));
+    if (is_streaming) {
+        solution::StreamingSolver solver(height, width);
+        std::vector<solution::MapValue> row(width);
+        for (size_t j = 0; j < height; ++j) {
+            common::getFromStdin(std::span(row));
+            solver.push(row);
+        }
+        const auto [points_sum, path] = solver.getResult();
+        printResult(points_sum, path);
+        return 0;
+    }
 
-    std::cout << points_sum << std::endl;
-    std::copy(path.rbegin(), path.rend(), std::ostream_iterator<char>(std::cout, " "));
-    std::cout << std::endl;
-}
\ No newline at end of file
+    solution::MapWithPoints map(height, width);
+    for (size_t j = 0; j < height; ++j) {
+        common::getFromStdin(map.getRow(j));
+    }
+
+    if (is_answering_queries) {
+        const auto queries_count = common::getFromStdin<std::size_t>();
+        std::vector<solution::RectangleQuery> queries;
+        queries.reserve(queries_count);
+        for (size_t q = 0; q < queries_count; ++q) {
+            solution::RectangleQuery query;
+            query.row_from = common::getFromStdin<std::size_t>() - 1;
+            query.column_from = common::getFromStdin<std::size_t>() - 1;
+            query.row_to = common::getFromStdin<std::size_t>() - 1;
+            query.column_to = common::getFromStdin<std::size_t>() - 1;
+            queries.push_back(query);
+        }
+        auto& output = common::getStdout();
+        for (const auto answer : solution::solveRectangleQueries(map, queries)) {
+            output.writeNumber(answer).writeSeparator('\n');
+        }
+        return 0;
+    }
+    if (top_routes_count != 0) {
+        for (const auto& [points_sum, path] : solution::solveTopRoutes(map, top_routes_count)) {
+            printResult(points_sum, path);
+        }
+        return 0;
+    }
+
+    std::optional<common::ThreadPool> pool;
+    if (is_wavefront) {
+        pool.emplace(threads_count);
+    }
+    const auto [points_sum, path] = solution::solve(map, pool ? &*pool : nullptr);
+    printResult(points_sum, path);
+}
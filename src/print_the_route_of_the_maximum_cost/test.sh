@@ -0,0 +1,59 @@
+#!/bin/bash
+# Проверки print_the_route_of_the_maximum_cost на маленьких входах: test.sh ПУТЬ_К_ПРОГРАММЕ
+set -u
+bin=$1
+source "$(dirname "$0")/../common/test.sh"
+
+example=$'5 5\n9 9 9 9 9\n3 0 0 0 0\n9 9 9 9 9\n6 6 6 6 8\n9 9 9 9 9\n'
+check "example" "$example" $'74\nD D R R R R D D '
+check "example wavefront" "$example" $'74\nD D R R R R D D ' --wavefront --threads 2
+check "example stream" "$example" $'74\nD D R R R R D D ' --stream
+
+# За краем сетки пути нет: сумма - это сумма настоящего маршрута во всех режимах, в том числе
+# с отрицательными клетками
+negative=$'3 1\n0\n-2\n5\n'
+check "negative" "$negative" $'3\nD D '
+check "negative wavefront" "$negative" $'3\nD D ' --wavefront --threads 2
+check "negative stream" "$negative" $'3\nD D ' --stream
+check "negative top" "$negative" $'3\nD D ' --top 1
+check "negative queries" "$negative"$'1\n1 1 3 1\n' "3" --queries
+check "negative sum" $'1 2\n-4 -5\n' $'-9\nR '
+
+# grid ВЫСОТА ШИРИНА - сетка с разными по знаку числами, одинаковая при каждом запуске
+grid() {
+    awk -v h="$1" -v w="$2" 'BEGIN {
+        print h, w
+        for (i = 0; i < h; ++i) {
+            line = ""
+            for (j = 0; j < w; ++j) {
+                line = line (j ? " " : "") ((i * 37 + j * 101 + i * j) % 199 - 99)
+            }
+            print line
+        }
+    }'
+}
+
+# Сетки, на которых работают векторные ядра полос (от 8 строк) и несколько плиток 256x1024,
+# сверяются с обычным режимом
+for size in "9 70" "300 1100"; do
+    input=$(grid $size)$'\n'
+    expected=$(printf '%s' "$input" | "$bin")
+    check "grid $size wavefront" "$input" "$expected" --wavefront --threads 3
+    check "grid $size stream" "$input" "$expected" --stream
+done
+
+# Суммы всех шести маршрутов разные, так что порядок однозначен
+check "top" $'3 3\n1 2 4\n8 16 32\n64 128 256\n' $'457\nD D R R \n409\nD R D R \n403\nR D D R \n313\nD R R D ' --top 4
+
+# Суммарная площадь запросов больше H*W*W*log(H), так что они решаются делением строк пополам
+queries=$'3 4\n3 -1 4 1\n-5 9 2 -6\n5 3 -5 8\n12\n'
+queries+=$'1 1 3 4\n1 1 3 4\n1 2 3 4\n1 1 2 4\n2 1 3 4\n1 1 3 3\n'
+queries+=$'1 1 3 4\n1 1 3 4\n2 2 3 4\n1 1 3 4\n3 1 3 4\n1 4 3 4\n'
+check "queries by halving" "$queries" $'17\n17\n14\n7\n10\n9\n17\n17\n15\n17\n11\n3' --queries
+
+# Режимы взаимоисключающие
+for flags in "--stream --top 2" "--stream --queries" "--top 2 --wavefront" "--top 2 --queries" "--wavefront --stream"; do
+    checkError "conflicting $flags" "$example" "Usage" $flags
+done
+
+finish